@@ -1,14 +1,14 @@
-#include <cstring>
 #include "Buffer.hpp"
 #include "Device.hpp"
-#include "CommandPool.hpp"
+#include "PhysicalDevice.hpp"
+#include "StagingRing.hpp"
 #include "VkCheck.hpp"
 #include "Utils.hpp"
 #include "Base.hpp"
 
 namespace Eternity
 {
-    Buffer::Buffer(const Device& device, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties)
+    Buffer::Buffer(const Device& device, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, const std::vector<uint32_t>& queueFamilies)
         : m_Device(device), m_Size(size)
     {
         VkBufferCreateInfo bufferInfo{};
@@ -16,67 +16,56 @@ namespace Eternity
         bufferInfo.size = size;
         bufferInfo.usage = usage;
         bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        if (queueFamilies.size() > 1)
+        {
+            bufferInfo.sharingMode              = VK_SHARING_MODE_CONCURRENT;
+            bufferInfo.queueFamilyIndexCount    = static_cast<uint32_t>(queueFamilies.size());
+            bufferInfo.pQueueFamilyIndices      = queueFamilies.data();
+        }
 
         VkCheck(vkCreateBuffer(m_Device, &bufferInfo, nullptr, &m_Buffer));
 
         VkMemoryRequirements memRequirements;
         vkGetBufferMemoryRequirements(m_Device, m_Buffer, &memRequirements);
 
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = FindMemoryType(m_Device.GetPhysicalDevice(), memRequirements.memoryTypeBits, properties);
+        m_Allocation = m_Device.GetAllocator().Allocate(memRequirements, properties, true);
 
-        VkCheck(vkAllocateMemory(m_Device, &allocInfo, nullptr, &m_Memory));
-
-        vkBindBufferMemory(m_Device, m_Buffer, m_Memory, 0);
+        VkCheck(vkBindBufferMemory(m_Device, m_Buffer, m_Allocation.memory, m_Allocation.offset));
     }
 
     Buffer::~Buffer()
     {
-        vkFreeMemory(m_Device, m_Memory, nullptr);
         vkDestroyBuffer(m_Device, m_Buffer, nullptr);
+        m_Device.GetAllocator().Free(m_Allocation);
     }
 
     void Buffer::MapMemory(void** data)
     {
-        vkMapMemory(m_Device, m_Memory, 0, m_Size, 0, data);
+        ET_ASSERT(m_Allocation.mapped != nullptr);
+        *data = m_Allocation.mapped;
     }
 
     void Buffer::UnmapMemory()
     {
-        vkUnmapMemory(m_Device, m_Memory);
     }
 
     /// Vuffer create helpers
-    std::shared_ptr<Buffer> CreateVertexBuffer(const CommandPool& commandPool, const void* verticesData, VkDeviceSize size)
+    std::shared_ptr<Buffer> CreateVertexBuffer(StagingRing& staging, const void* verticesData, VkDeviceSize size)
     {
-        Buffer stagingBuffer (commandPool.GetDevice(), size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-        
-        void* data;
-        stagingBuffer.MapMemory(&data);
-            std::memcpy(data, verticesData, (size_t) size);
-        stagingBuffer.UnmapMemory();
-
-        auto vertexBuffer = std::make_shared<Eternity::Buffer>(commandPool.GetDevice(), size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        auto vertexBuffer = std::make_shared<Eternity::Buffer>(staging.GetDevice(), size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            staging.GetDevice().GetPhysicalDevice().GetUploadQueueFamilies());
 
-        commandPool.CopyBuffer(stagingBuffer, *vertexBuffer, size);
+        staging.Upload(*vertexBuffer, 0, verticesData, size);
 
         return vertexBuffer;
     }
 
-    std::shared_ptr<Buffer> CreateIndexBuffer(const CommandPool& commandPool, const void* indicesData, VkDeviceSize size)
+    std::shared_ptr<Buffer> CreateIndexBuffer(StagingRing& staging, const void* indicesData, VkDeviceSize size)
     {
-        Buffer stagingBuffer (commandPool.GetDevice(), size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-        void* data;
-        stagingBuffer.MapMemory(&data);
-            std::memcpy(data, indicesData, (size_t) size);
-        stagingBuffer.UnmapMemory();
-
-        auto indexBuffer = std::make_shared<Eternity::Buffer>(commandPool.GetDevice(), size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        auto indexBuffer = std::make_shared<Eternity::Buffer>(staging.GetDevice(), size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            staging.GetDevice().GetPhysicalDevice().GetUploadQueueFamilies());
         
-        commandPool.CopyBuffer(stagingBuffer, *indexBuffer, size);
+        staging.Upload(*indexBuffer, 0, indicesData, size);
         
         return indexBuffer;
     }
@@ -1,24 +1,28 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <vulkan/vulkan.h>
+#include "MemoryAllocator.hpp"
 
 namespace Eternity
 {
     class Device;
-    class CommandPool;
+    class StagingRing;
 
     class Buffer
     {
         protected:
-            const Device&   m_Device;
-            VkBuffer        m_Buffer;
-            VkDeviceMemory  m_Memory;
-            VkDeviceSize    m_Size;
+            const Device&       m_Device;
+            VkBuffer            m_Buffer;
+            MemoryAllocation    m_Allocation;
+            VkDeviceSize        m_Size;
         public:
-            Buffer(const Device& device, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+            /// Buffer used by more than one of queueFamilies is shared by them, otherwise owned by the one using it
+            Buffer(const Device& device, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, const std::vector<uint32_t>& queueFamilies = {});
             ~Buffer();
 
+            /// Host visible buffers stay mapped while they live, map and unmap only hand out the address
             void MapMemory(void** data);
             void UnmapMemory();
             
@@ -28,8 +32,16 @@ namespace Eternity
             operator VkBuffer() const { return m_Buffer; }
     };
     
-    /// Vuffer create helpers
-    std::shared_ptr<Buffer> CreateVertexBuffer(const CommandPool& commandPool, const void* data, VkDeviceSize size);
-    std::shared_ptr<Buffer> CreateIndexBuffer(const CommandPool& commandPool, const void* data, VkDeviceSize size);
+    /// Region copied from one buffer to another, or inside one buffer when they are the same
+    struct BufferCopy
+    {
+        const Buffer*   source;
+        Buffer*         destination;
+        VkBufferCopy    region;
+    };
+
+    /// Vuffer create helpers, data is copied by next batch of staging
+    std::shared_ptr<Buffer> CreateVertexBuffer(StagingRing& staging, const void* data, VkDeviceSize size);
+    std::shared_ptr<Buffer> CreateIndexBuffer(StagingRing& staging, const void* data, VkDeviceSize size);
     
 } // namespace Eternity
@@ -33,6 +33,11 @@ namespace Eternity
         VkCheck(vkBeginCommandBuffer(m_Buffer, &beginInfo));
     }
 
+    void CommandBuffer::Reset() const
+    {
+        VkCheck(vkResetCommandBuffer(m_Buffer, 0));
+    }
+
     void CommandBuffer::BeginSingleTime() const
     {
         VkCommandBufferBeginInfo beginInfo{};
@@ -66,8 +71,8 @@ namespace Eternity
         submitInfo.commandBufferCount   = 1;
         submitInfo.pCommandBuffers      = &m_Buffer;
 
-        vkQueueSubmit(m_Device.GetQueue(QueueType::Graphics), 1, &submitInfo, VK_NULL_HANDLE);
-        vkQueueWaitIdle(m_Device.GetQueue(QueueType::Graphics));
+        vkQueueSubmit(m_Device.GetQueue(m_CommandPool.GetQueueType()), 1, &submitInfo, VK_NULL_HANDLE);
+        vkQueueWaitIdle(m_Device.GetQueue(m_CommandPool.GetQueueType()));
     }
 
     void CommandBuffer::End() const
@@ -20,6 +20,8 @@ namespace Eternity
             ~CommandBuffer();
 
             void Begin() const;
+            /// Back to initial state so it can be recorded again, it mustn't be pending on GPU
+            void Reset() const;
             void BeginSingleTime() const;
             void BeginRenderPass(const VkRenderPassBeginInfo* beginInfo, const VkSubpassContents& contents);
             void BindPipeline(VkPipelineBindPoint pipelineBindPoint, VkPipeline pipeline);
@@ -0,0 +1,210 @@
+#include "GeometryBuffer.hpp"
+#include "Device.hpp"
+#include "PhysicalDevice.hpp"
+#include "StagingRing.hpp"
+#include "DeletionQueue.hpp"
+#include "Base.hpp"
+
+#include <algorithm>
+
+namespace Eternity
+{
+    static const VkBufferUsageFlags vertexUsage     = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    static const VkBufferUsageFlags indexUsage      = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    static const VkBufferUsageFlags indirectUsage   = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    /// Holes outside the largest free range hold more than an eighth of capacity
+    static bool IsFragmented(const RangeAllocator& ranges)
+    {
+        return ranges.GetFreeCount() - ranges.GetLargestFree() > ranges.GetCapacity() / 8;
+    }
+
+    GeometryBuffer::GeometryBuffer(StagingRing& staging, DeletionQueue& deletions, VkDeviceSize vertexStride, uint32_t vertexCapacity, uint32_t indexCapacity, uint32_t drawCapacity)
+        : m_Staging(staging), m_Deletions(deletions), m_VertexStride(vertexStride), m_Vertices(vertexCapacity), m_Indices(indexCapacity), m_DrawSlots(drawCapacity)
+    {
+        const Device& device = m_Staging.GetDevice();
+        const std::vector<uint32_t> families = device.GetPhysicalDevice().GetUploadQueueFamilies();
+        m_VertexBuffer      = std::make_unique<Buffer>(device, vertexCapacity * m_VertexStride, vertexUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, families);
+        m_IndexBuffer       = std::make_unique<Buffer>(device, indexCapacity * sizeof(uint32_t), indexUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, families);
+        m_IndirectBuffer    = std::make_unique<Buffer>(device, drawCapacity * sizeof(VkDrawIndexedIndirectCommand), indirectUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, families);
+        m_Meshes.resize(drawCapacity, nullptr);
+    }
+
+    GeometryBuffer::~GeometryBuffer()
+    {
+        ET_ASSERT(std::count(m_Meshes.begin(), m_Meshes.end(), nullptr) == static_cast<std::ptrdiff_t>(m_Meshes.size()));
+    }
+
+    void GeometryBuffer::Grow(std::unique_ptr<Buffer>& buffer, RangeAllocator& ranges, VkDeviceSize stride, uint32_t size, VkBufferUsageFlags usage)
+    {
+        const uint32_t capacity = std::max(ranges.GetCapacity() * 2, ranges.GetCapacity() + size);
+        const Device& device = m_Staging.GetDevice();
+        auto grown = std::make_unique<Buffer>(device, capacity * stride, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, device.GetPhysicalDevice().GetUploadQueueFamilies());
+        m_Staging.Copy({ { buffer.get(), grown.get(), { 0, 0, buffer->GetSize() } } });
+
+        // Copy is submitted ahead of current frame, so old buffer outlives it and frames in flight once that frame is done
+        m_Deletions.Push(std::move(buffer));
+        buffer = std::move(grown);
+        ranges.Grow(capacity);
+        ET_TRACE("Geometry buffer grown to", capacity, "elements");
+    }
+
+    std::shared_ptr<MeshRange> GeometryBuffer::Allocate(uint32_t vertexCapacity, uint32_t indexCapacity)
+    {
+        uint32_t vertexOffset = m_Vertices.Allocate(vertexCapacity);
+        if (vertexOffset == RangeAllocator::invalidOffset)
+        {
+            Grow(m_VertexBuffer, m_Vertices, m_VertexStride, vertexCapacity, vertexUsage);
+            vertexOffset = m_Vertices.Allocate(vertexCapacity);
+        }
+
+        uint32_t indexOffset = m_Indices.Allocate(indexCapacity);
+        if (indexOffset == RangeAllocator::invalidOffset)
+        {
+            Grow(m_IndexBuffer, m_Indices, sizeof(uint32_t), indexCapacity, indexUsage);
+            indexOffset = m_Indices.Allocate(indexCapacity);
+        }
+
+        uint32_t drawSlot = m_DrawSlots.Allocate(1);
+        if (drawSlot == RangeAllocator::invalidOffset)
+        {
+            Grow(m_IndirectBuffer, m_DrawSlots, sizeof(VkDrawIndexedIndirectCommand), 1, indirectUsage);
+            drawSlot = m_DrawSlots.Allocate(1);
+            m_Meshes.resize(m_DrawSlots.GetCapacity(), nullptr);
+        }
+
+        MeshRange* mesh = new MeshRange{ vertexOffset, vertexCapacity, 0, indexOffset, indexCapacity, 0, drawSlot };
+        m_Meshes[drawSlot] = mesh;
+        return std::shared_ptr<MeshRange>(mesh, [this](MeshRange* range) { Free(range); });
+    }
+
+    void GeometryBuffer::Free(MeshRange* mesh)
+    {
+        // Owners drop meshes through deletion queue, so uploads into freed ranges don't have to wait for draws
+        m_Vertices.Free(mesh->vertexOffset, mesh->vertexCapacity);
+        m_Indices.Free(mesh->indexOffset, mesh->indexCapacity);
+        m_DrawSlots.Free(mesh->drawSlot, 1);
+        m_Meshes[mesh->drawSlot] = nullptr;
+        delete mesh;
+    }
+
+    void GeometryBuffer::Upload(MeshRange& mesh, const void* vertices, uint32_t firstVertex, uint32_t vertexCount, const uint32_t* indices, uint32_t firstIndex, uint32_t indexCount)
+    {
+        ET_ASSERT(vertexCount <= mesh.vertexCapacity && indexCount <= mesh.indexCapacity);
+        // Ranges come back only once no frame draws them, so only geometry uploaded before may be drawn
+        if (mesh.indexCount != 0)
+            m_Staging.WaitForDraws();
+        mesh.vertexCount    = vertexCount;
+        mesh.indexCount     = indexCount;
+
+        // Index count is read by the draw from buffer, so recorded commands stay valid when it changes
+        VkDrawIndexedIndirectCommand draw{};
+        draw.indexCount     = indexCount;
+        draw.instanceCount  = 1;
+        draw.firstIndex     = mesh.indexOffset;
+        draw.vertexOffset   = static_cast<int32_t>(mesh.vertexOffset);
+
+        m_Staging.Upload(*m_VertexBuffer, (mesh.vertexOffset + firstVertex) * m_VertexStride, static_cast<const char*>(vertices) + firstVertex * m_VertexStride, (vertexCount - firstVertex) * m_VertexStride);
+        m_Staging.Upload(*m_IndexBuffer, (mesh.indexOffset + firstIndex) * sizeof(uint32_t), indices + firstIndex, (indexCount - firstIndex) * sizeof(uint32_t));
+        m_Staging.Upload(*m_IndirectBuffer, GetDrawOffset(mesh), &draw, sizeof(draw));
+    }
+
+    VkDeviceSize GeometryBuffer::CompactRanges(bool vertices, VkDeviceSize budget, std::vector<BufferCopy>& moves, Ranges& released, std::vector<MeshRange*>& moved)
+    {
+        RangeAllocator& ranges  = vertices ? m_Vertices : m_Indices;
+        Buffer* buffer          = vertices ? m_VertexBuffer.get() : m_IndexBuffer.get();
+        const VkDeviceSize stride = vertices ? m_VertexStride : sizeof(uint32_t);
+        if (!IsFragmented(ranges))
+            return 0;
+
+        std::vector<MeshRange*> meshes;
+        for (MeshRange* mesh : m_Meshes)
+            if (mesh != nullptr)
+                meshes.push_back(mesh);
+
+        // Highest meshes first, emptying the end merges holes into one free range there
+        auto offset = [vertices](MeshRange* mesh) -> uint32_t& { return vertices ? mesh->vertexOffset : mesh->indexOffset; };
+        std::sort(meshes.begin(), meshes.end(), [&](MeshRange* a, MeshRange* b) { return offset(a) > offset(b); });
+
+        VkDeviceSize copied = 0;
+        for (MeshRange* mesh : meshes)
+        {
+            const uint32_t capacity = vertices ? mesh->vertexCapacity : mesh->indexCapacity;
+            const uint32_t count    = vertices ? mesh->vertexCount : mesh->indexCount;
+            if (copied + count * stride > budget)
+                break;
+
+            // Old ranges are given back after all moves, so no move writes what another one reads
+            const uint32_t target = ranges.Allocate(capacity);
+            if (target == RangeAllocator::invalidOffset)
+                continue;
+            if (target > offset(mesh))
+            {
+                // Nothing below fits, mesh stays at the end until holes merge
+                ranges.Free(target, capacity);
+                break;
+            }
+
+            if (count != 0)
+                moves.push_back({ buffer, buffer, { offset(mesh) * stride, target * stride, count * stride } });
+            released.push_back({ offset(mesh), capacity });
+            moved.push_back(mesh);
+            offset(mesh) = target;
+            copied += count * stride;
+        }
+        return copied;
+    }
+
+    void GeometryBuffer::Compact(VkDeviceSize budget)
+    {
+        std::vector<BufferCopy> moves;
+        Ranges releasedVertices;
+        Ranges releasedIndices;
+        std::vector<MeshRange*> moved;
+
+        const VkDeviceSize copied = CompactRanges(true, budget, moves, releasedVertices, moved);
+        CompactRanges(false, budget - copied, moves, releasedIndices, moved);
+        if (moved.empty())
+            return;
+
+        // Moves go into free ranges, but draw commands of moved meshes are read by frames in flight
+        m_Staging.WaitForDraws();
+        m_Staging.Copy(moves);
+
+        // Draws submitted from now on read moved geometry, earlier ones still find it at old place
+        std::sort(moved.begin(), moved.end());
+        moved.erase(std::unique(moved.begin(), moved.end()), moved.end());
+
+        for (const MeshRange* mesh : moved)
+        {
+            VkDrawIndexedIndirectCommand draw{};
+            draw.indexCount     = mesh->indexCount;
+            draw.instanceCount  = 1;
+            draw.firstIndex     = mesh->indexOffset;
+            draw.vertexOffset   = static_cast<int32_t>(mesh->vertexOffset);
+            m_Staging.Upload(*m_IndirectBuffer, GetDrawOffset(*mesh), &draw, sizeof(draw));
+        }
+
+        ET_TRACE("Geometry compacted,", releasedVertices.size(), "vertex and", releasedIndices.size(), "index ranges moved");
+
+        // Old places are given back once frames drawing from them are done
+        auto released = new std::pair<Ranges, Ranges>(std::move(releasedVertices), std::move(releasedIndices));
+        m_Deletions.Push(std::shared_ptr<void>(released, [this](std::pair<Ranges, Ranges>* ranges)
+        {
+            for (const auto& range : ranges->first)
+                m_Vertices.Free(range.first, range.second);
+            for (const auto& range : ranges->second)
+                m_Indices.Free(range.first, range.second);
+            delete ranges;
+        }));
+    }
+
+    void GeometryBuffer::ReportStats() const
+    {
+        const RangeAllocator* ranges[] = { &m_Vertices, &m_Indices };
+        const char* names[] = { "vertices", "indices" };
+        for (int i = 0; i < 2; i++)
+            ET_INFO("Geometry", names[i], ":", ranges[i]->GetCapacity() - ranges[i]->GetFreeCount(), "of", ranges[i]->GetCapacity(), "taken, largest free range", ranges[i]->GetLargestFree());
+        ET_INFO("Geometry draws:", m_DrawSlots.GetCapacity() - m_DrawSlots.GetFreeCount(), "of", m_DrawSlots.GetCapacity(), "slots taken");
+    }
+} // namespace Eternity
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "Buffer.hpp"
+#include "MemoryAllocator.hpp"
+
+namespace Eternity
+{
+    class StagingRing;
+    class DeletionQueue;
+
+    /// Element ranges of one mesh inside GeometryBuffer. Its draw command lives at drawSlot of the indirect buffer
+    struct MeshRange
+    {
+        uint32_t    vertexOffset;
+        uint32_t    vertexCapacity;
+        uint32_t    vertexCount;        // uploaded so far, only these are moved by compaction
+        uint32_t    indexOffset;
+        uint32_t    indexCapacity;
+        uint32_t    indexCount;
+        uint32_t    drawSlot;
+        uint32_t    users = 0;          // models drawing range, owners like deletion queue don't count
+    };
+
+    /// Geometry of all meshes in one vertex buffer and one index buffer, so a scene binds them once and draws each
+    /// mesh through its own indexed indirect command with firstIndex and vertexOffset of its ranges. Full buffers are
+    /// replaced by ones twice as big. Compact moves meshes down into holes a few at a time, their draw commands follow
+    class GeometryBuffer
+    {
+        private:
+            /// Offset and size of element ranges
+            using Ranges = std::vector<std::pair<uint32_t, uint32_t>>;
+
+            StagingRing&                m_Staging;
+            DeletionQueue&              m_Deletions;    // replaced buffers, until frames drawing from them are done
+            const VkDeviceSize          m_VertexStride;
+
+            std::unique_ptr<Buffer>     m_VertexBuffer;
+            std::unique_ptr<Buffer>     m_IndexBuffer;
+            std::unique_ptr<Buffer>     m_IndirectBuffer;
+            RangeAllocator              m_Vertices;
+            RangeAllocator              m_Indices;
+            RangeAllocator              m_DrawSlots;
+            std::vector<MeshRange*>     m_Meshes;       // live meshes by draw slot, null for free slots
+
+            /// Replace buffer by bigger one with same content, so ranges gets size more free elements at least
+            void Grow(std::unique_ptr<Buffer>& buffer, RangeAllocator& ranges, VkDeviceSize stride, uint32_t size, VkBufferUsageFlags usage);
+            void Free(MeshRange* mesh);
+            /// Move meshes at the end of ranges into lower holes, returns bytes copied
+            VkDeviceSize CompactRanges(bool vertices, VkDeviceSize budget, std::vector<BufferCopy>& moves, Ranges& released, std::vector<MeshRange*>& moved);
+        public:
+            GeometryBuffer(StagingRing& staging, DeletionQueue& deletions, VkDeviceSize vertexStride, uint32_t vertexCapacity, uint32_t indexCapacity, uint32_t drawCapacity);
+            ~GeometryBuffer();
+
+            /// Ranges stay taken until last owner drops them, through DeletionQueue while frames may draw them.
+            /// Buffers may be replaced, commands binding them have to be recorded again
+            std::shared_ptr<MeshRange> Allocate(uint32_t vertexCapacity, uint32_t indexCapacity);
+            /// Stage vertices and indices from first given ones on, draw command is set to indexCount indices
+            void Upload(MeshRange& mesh, const void* vertices, uint32_t firstVertex, uint32_t vertexCount, const uint32_t* indices, uint32_t firstIndex, uint32_t indexCount);
+            /// Copy at most budget bytes of meshes into holes, once enough space is lost to holes
+            void Compact(VkDeviceSize budget);
+
+            const Buffer&   GetVertexBuffer() const { return *m_VertexBuffer; }
+            const Buffer&   GetIndexBuffer() const { return *m_IndexBuffer; }
+            const Buffer&   GetIndirectBuffer() const { return *m_IndirectBuffer; }
+            VkDeviceSize    GetDrawOffset(const MeshRange& mesh) const { return mesh.drawSlot * sizeof(VkDrawIndexedIndirectCommand); }
+
+            void ReportStats() const;
+    };
+} // namespace Eternity
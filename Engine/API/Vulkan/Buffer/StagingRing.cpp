@@ -0,0 +1,238 @@
+#include <cstring>
+#include "StagingRing.hpp"
+#include "Device.hpp"
+#include "PhysicalDevice.hpp"
+#include "CommandPool.hpp"
+#include "CommandBuffer.hpp"
+#include "VkCheck.hpp"
+#include "Base.hpp"
+
+namespace Eternity
+{
+    static const VkPipelineStageFlags drawStages    = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    static const VkAccessFlags drawAccess           = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+    static const VkAccessFlags transferAccess       = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    static const VkDeviceSize stagingAlignment      = 16;
+
+    static void TransferBarrier(VkCommandBuffer buffer, VkPipelineStageFlags srcStages, VkAccessFlags srcAccess, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess)
+    {
+        VkMemoryBarrier barrier{};
+        barrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask   = srcAccess;
+        barrier.dstAccessMask   = dstAccess;
+        vkCmdPipelineBarrier(buffer, srcStages, dstStages, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    static VkSemaphore CreateTimeline(const Device& device)
+    {
+        VkSemaphoreTypeCreateInfo typeInfo{};
+        typeInfo.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        typeInfo.semaphoreType  = VK_SEMAPHORE_TYPE_TIMELINE;
+        typeInfo.initialValue   = 0;
+
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreInfo.pNext = &typeInfo;
+
+        VkSemaphore semaphore;
+        VkCheck(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore));
+        return semaphore;
+    }
+
+    StagingRing::StagingRing(const CommandPool& commandPool, VkDeviceSize size)
+        : m_CommandPool(commandPool), m_Device(commandPool.GetDevice()),
+          m_TransferFamily(m_Device.GetPhysicalDevice().HasTransferFamily()),
+          m_Buffer(m_Device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+    {
+        void* data;
+        m_Buffer.MapMemory(&data);
+        m_Mapped = static_cast<char*>(data);
+
+        m_Copied    = CreateTimeline(m_Device);
+        m_Drawn     = CreateTimeline(m_Device);
+    }
+
+    StagingRing::~StagingRing()
+    {
+        Flush();
+        for (VkFence fence : m_FreeFences)
+            vkDestroyFence(m_Device, fence, nullptr);
+        vkDestroySemaphore(m_Device, m_Copied, nullptr);
+        vkDestroySemaphore(m_Device, m_Drawn, nullptr);
+    }
+
+    CommandBuffer& StagingRing::GetCommands()
+    {
+        if (m_Recording.commands == nullptr)
+        {
+            m_Recording.commands = std::make_unique<CommandBuffer>(m_Device, m_CommandPool);
+            m_Recording.commands->BeginSingleTime();
+
+            // Batches before may still copy into same buffers
+            TransferBarrier(*m_Recording.commands, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, transferAccess);
+        }
+        return *m_Recording.commands;
+    }
+
+    VkDeviceSize StagingRing::Stage(const void* data, VkDeviceSize size)
+    {
+        const uint64_t ringSize = m_Buffer.GetSize();
+        for (;;)
+        {
+            // Data doesn't wrap around, it starts over at the beginning when it would
+            uint64_t position = (m_Head + stagingAlignment - 1) & ~(stagingAlignment - 1);
+            if (position % ringSize + size > ringSize)
+                position = (position / ringSize + 1) * ringSize;
+
+            if (position + size - m_Tail <= ringSize)
+            {
+                m_Head = position + size;
+                std::memcpy(m_Mapped + position % ringSize, data, static_cast<size_t>(size));
+                return position % ringSize;
+            }
+
+            // Ring is full, oldest batch has to finish first
+            ET_TRACE("Staging ring full, waiting for GPU");
+            if (m_InFlight.empty())
+            {
+                // Copy this is staged for goes to next batch, which has to wait for draws as well
+                const bool waitForDraws = m_Recording.waitForDraws;
+                Submit();
+                m_Recording.waitForDraws = waitForDraws;
+            }
+            Retire(true);
+        }
+    }
+
+    void StagingRing::Retire(bool wait)
+    {
+        while (!m_InFlight.empty())
+        {
+            Batch& batch = m_InFlight.front();
+            if (wait)
+            {
+                VkCheck(vkWaitForFences(m_Device, 1, &batch.fence, VK_TRUE, UINT64_MAX));
+                wait = false;
+            }
+            else if (vkGetFenceStatus(m_Device, batch.fence) != VK_SUCCESS)
+                break;
+
+            m_Tail = batch.end;
+            VkCheck(vkResetFences(m_Device, 1, &batch.fence));
+            m_FreeFences.push_back(batch.fence);
+            m_InFlight.pop_front();
+        }
+    }
+
+    void StagingRing::Upload(Buffer& buffer, VkDeviceSize offset, const void* data, VkDeviceSize size)
+    {
+        if (size == 0)
+            return;
+
+        VkBufferCopy region{};
+        region.dstOffset    = offset;
+        region.size         = size;
+
+        // Ring would have to be emptied for upload over half its size, it gets staging buffer of its own
+        if (size > m_Buffer.GetSize() / 2)
+        {
+            auto staging = std::make_unique<Buffer>(m_Device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            void* mapped;
+            staging->MapMemory(&mapped);
+            std::memcpy(mapped, data, static_cast<size_t>(size));
+
+            vkCmdCopyBuffer(GetCommands(), *staging, buffer, 1, &region);
+            m_Recording.oversized.push_back(std::move(staging));
+            return;
+        }
+
+        // Staging may submit recorded batch to make room, so commands are taken afterwards
+        region.srcOffset = Stage(data, size);
+        vkCmdCopyBuffer(GetCommands(), m_Buffer, buffer, 1, &region);
+    }
+
+    void StagingRing::Copy(const std::vector<BufferCopy>& copies)
+    {
+        if (copies.empty())
+            return;
+
+        CommandBuffer& commands = GetCommands();
+        TransferBarrier(commands, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, transferAccess);
+
+        for (const BufferCopy& copy : copies)
+            vkCmdCopyBuffer(commands, *copy.source, *copy.destination, 1, &copy.region);
+
+        TransferBarrier(commands, VK_PIPELINE_STAGE_TRANSFER_BIT, transferAccess, VK_PIPELINE_STAGE_TRANSFER_BIT, transferAccess);
+    }
+
+    void StagingRing::WaitForDraws()
+    {
+        // On graphics queue draws submitted before are ordered by barrier, transfer queue waits for semaphore of last frame
+        if (!m_TransferFamily)
+            TransferBarrier(GetCommands(), drawStages, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, transferAccess);
+        else
+            m_Recording.waitForDraws = true;
+    }
+
+    void StagingRing::Submit()
+    {
+        if (m_Recording.commands == nullptr)
+            return;
+
+        if (m_FreeFences.empty())
+        {
+            VkFenceCreateInfo fenceInfo{};
+            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+            VkFence fence;
+            VkCheck(vkCreateFence(m_Device, &fenceInfo, nullptr, &fence));
+            m_FreeFences.push_back(fence);
+        }
+        m_Recording.fence = m_FreeFences.back();
+        m_FreeFences.pop_back();
+        m_Recording.end = m_Head;
+
+        // Semaphores make copies visible to frames on other queue, on same queue barrier does
+        if (!m_TransferFamily)
+            TransferBarrier(*m_Recording.commands, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, drawStages, drawAccess);
+        m_Recording.commands->End();
+
+        const VkCommandBuffer commands      = *m_Recording.commands;
+        const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        const uint64_t copiedValue          = ++m_CopiedValue;
+
+        VkTimelineSemaphoreSubmitInfo timelineInfo{};
+        timelineInfo.sType                      = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.signalSemaphoreValueCount  = 1;
+        timelineInfo.pSignalSemaphoreValues     = &copiedValue;
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.pNext                = &timelineInfo;
+        submitInfo.commandBufferCount   = 1;
+        submitInfo.pCommandBuffers      = &commands;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores    = &m_Copied;
+        if (m_Recording.waitForDraws && m_DrawnValue != 0)
+        {
+            timelineInfo.waitSemaphoreValueCount    = 1;
+            timelineInfo.pWaitSemaphoreValues       = &m_DrawnValue;
+            submitInfo.waitSemaphoreCount           = 1;
+            submitInfo.pWaitSemaphores              = &m_Drawn;
+            submitInfo.pWaitDstStageMask            = &waitStage;
+        }
+
+        VkCheck(vkQueueSubmit(m_Device.GetQueue(m_CommandPool.GetQueueType()), 1, &submitInfo, m_Recording.fence));
+
+        m_InFlight.push_back(std::move(m_Recording));
+        m_Recording = Batch();
+        Retire(false);
+    }
+
+    void StagingRing::Flush()
+    {
+        Submit();
+        while (!m_InFlight.empty())
+            Retire(true);
+    }
+} // namespace Eternity
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "Buffer.hpp"
+
+namespace Eternity
+{
+    class Device;
+    class CommandPool;
+    class CommandBuffer;
+
+    /// Persistently mapped host visible buffer uploads are staged in, used as a ring. Copies are recorded into one
+    /// command buffer per batch and Submit hands it to transfer queue with a fence, without waiting for it. Ring
+    /// space of a batch is reused only once its fence signalled, so CPU waits for GPU only when ring is full.
+    ///
+    /// Buffers uploads write are shared by graphics and transfer family (PhysicalDevice::GetUploadQueueFamilies),
+    /// so nothing changes owner. Frames wait on copy semaphore for copies submitted before them, copies wait on draw
+    /// semaphore only when they overwrite what earlier frames draw, so other uploads run alongside rendering
+    class StagingRing
+    {
+        private:
+            struct Batch
+            {
+                std::unique_ptr<CommandBuffer>          commands;       // null until something is recorded
+                VkFence                                 fence   = VK_NULL_HANDLE;
+                uint64_t                                end     = 0;    // ring position after last byte staged for batch
+                bool                                    waitForDraws = false;
+                std::vector<std::unique_ptr<Buffer>>    oversized;      // own staging of uploads too big for ring
+            };
+
+            const CommandPool&              m_CommandPool;
+            const Device&                   m_Device;
+            const bool                      m_TransferFamily;   // transfer queue isn't graphics queue
+            Buffer                          m_Buffer;
+            char*                           m_Mapped;
+            uint64_t                        m_Head = 0;         // positions only grow, ring offset is position modulo ring size
+            uint64_t                        m_Tail = 0;         // first byte GPU may still read
+            Batch                           m_Recording;
+            std::deque<Batch>               m_InFlight;         // submitted batches, oldest first
+            std::vector<VkFence>            m_FreeFences;
+
+            VkSemaphore                     m_Copied;           // timeline, value of each submitted batch
+            uint64_t                        m_CopiedValue = 0;
+            VkSemaphore                     m_Drawn;            // timeline, value of each submitted frame
+            uint64_t                        m_DrawnValue = 0;
+
+            CommandBuffer&  GetCommands();
+            /// Copy data into ring, returns its offset in m_Buffer
+            VkDeviceSize    Stage(const void* data, VkDeviceSize size);
+            /// Give back space of finished batches, waiting for oldest one first when wait is set
+            void            Retire(bool wait);
+        public:
+            /// Command buffers of pool go to its queue, transfer queue when device has one
+            StagingRing(const CommandPool& commandPool, VkDeviceSize size);
+            ~StagingRing();
+
+            /// Write data at offset of device local buffer. Draws submitted after batch see it
+            void Upload(Buffer& buffer, VkDeviceSize offset, const void* data, VkDeviceSize size);
+            /// Copy between or inside device local buffers, ordered after and before every other copy of batch
+            void Copy(const std::vector<BufferCopy>& copies);
+            /// Copies recorded from now on overwrite what frames submitted before may still draw, they wait for them
+            void WaitForDraws();
+            /// Submit copies recorded so far, nothing happens when there are none
+            void Submit();
+            /// Submit and wait until GPU has done every batch
+            void Flush();
+
+            /// Frame submission waits for this value, copies submitted before it are done then
+            VkSemaphore GetCopySemaphore() const { return m_Copied; }
+            uint64_t    GetCopyValue() const { return m_CopiedValue; }
+            /// Frame submission signals returned value, copies waiting for draws wait for last one
+            VkSemaphore GetDrawSemaphore() const { return m_Drawn; }
+            uint64_t    NextDrawValue() { return ++m_DrawnValue; }
+
+            const Device& GetDevice() const { return m_Device; }
+    };
+} // namespace Eternity
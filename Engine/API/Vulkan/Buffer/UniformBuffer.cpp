@@ -1,6 +1,7 @@
 #include "UniformBuffer.hpp"
 #include "Device.hpp"
 #include "Descriptors.hpp"
+#include "Base.hpp"
 
 namespace Eternity
 {
@@ -9,7 +10,8 @@ namespace Eternity
 
     void UniformBuffer::MapMemory(VkDeviceSize size, void** data)
     {
-        vkMapMemory(m_Device, m_Memory, 0, size, 0, data);
+        ET_ASSERT(size <= m_Size);
+        Buffer::MapMemory(data);
     }
 
     WriteDescriptorSet UniformBuffer::GetWriteDescriptorSet(uint32_t binding, uint32_t count, VkDeviceSize range, VkDeviceSize offset /* = 0 */)
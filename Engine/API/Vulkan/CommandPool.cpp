@@ -8,13 +8,14 @@
 
 namespace Eternity
 {
-    CommandPool::CommandPool(const Device& device)
-        : m_Device(device)
+    CommandPool::CommandPool(const Device& device, QueueType queueType /* = QueueType::Graphics */)
+        : m_Device(device), m_QueueType(queueType)
     {
         VkCommandPoolCreateInfo poolInfo{};
         poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        poolInfo.queueFamilyIndex = m_Device.GetPhysicalDevice().GetQueueFamilyIndex(QueueType::Graphics);
-        // poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        poolInfo.queueFamilyIndex = m_Device.GetPhysicalDevice().GetQueueFamilyIndex(m_QueueType);
+        // Frame command buffers are recorded again whenever visible models change
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
         VkCheck(vkCreateCommandPool(m_Device, &poolInfo, nullptr, &m_CommandPool));
         ET_TRACE("Command pool created");
     }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include "PhysicalDevice.hpp"
 
 namespace Eternity
 {
@@ -12,10 +13,12 @@ namespace Eternity
     {
         private:
             const Device&   m_Device;
+            const QueueType m_QueueType;
 
             VkCommandPool   m_CommandPool;
         public:
-            CommandPool(const Device& device);
+            /// Command buffers of pool are submitted to queue of type
+            CommandPool(const Device& device, QueueType queueType = QueueType::Graphics);
             ~CommandPool();
 
             CommandBuffer   BeginSingleTimeCommands() const;
@@ -24,6 +27,7 @@ namespace Eternity
             void            CopyBuffer(const Buffer& srcBuffer, Buffer& dstBuffer, VkDeviceSize size) const;
 
             const Device& GetDevice() const { return m_Device; }
+            QueueType GetQueueType() const { return m_QueueType; }
             operator VkCommandPool() { return m_CommandPool; }
             operator VkCommandPool() const { return m_CommandPool; }
     };
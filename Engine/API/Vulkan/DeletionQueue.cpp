@@ -0,0 +1,27 @@
+#include "DeletionQueue.hpp"
+#include "Base.hpp"
+
+namespace Eternity
+{
+    DeletionQueue::~DeletionQueue()
+    {
+        ET_ASSERT(m_Entries.empty());
+    }
+
+    void DeletionQueue::Push(std::shared_ptr<void> resource)
+    {
+        if (resource != nullptr)
+            m_Entries.push_back({ m_Frame, std::move(resource) });
+    }
+
+    void DeletionQueue::Collect(uint64_t frame)
+    {
+        while (!m_Entries.empty() && m_Entries.front().frame <= frame)
+            m_Entries.pop_front();
+    }
+
+    void DeletionQueue::Clear()
+    {
+        m_Entries.clear();
+    }
+} // namespace Eternity
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+namespace Eternity
+{
+    /// Buffers, images, descriptor sets and mesh ranges released while frames using them may still be in flight.
+    /// Each is tagged with frame being recorded when it's pushed and kept alive until that frame's fence signalled,
+    /// so releasing them never waits for device
+    class DeletionQueue
+    {
+        private:
+            struct Entry
+            {
+                uint64_t                frame;
+                std::shared_ptr<void>   resource;   // last owner, its deleter does the destruction
+            };
+
+            std::deque<Entry>   m_Entries;          // oldest frame first
+            uint64_t            m_Frame = 0;        // counts submitted frames, so it's also number of next one
+        public:
+            DeletionQueue() = default;
+            ~DeletionQueue();
+
+            /// Destroy resource once current frame is done, owners left elsewhere keep it longer
+            void Push(std::shared_ptr<void> resource);
+            /// Current frame is submitted, resources pushed from now on belong to next one
+            void EndFrame() { m_Frame++; }
+            /// Destroy resources of frames up to frame, whose fence was waited for
+            void Collect(uint64_t frame);
+            /// Device is idle, everything goes
+            void Clear();
+
+            uint64_t GetFrame() const { return m_Frame; }
+    };
+} // namespace Eternity
@@ -3,6 +3,7 @@
 #include "VkCheck.hpp"
 #include "Instance.hpp"
 #include "PhysicalDevice.hpp"
+#include "MemoryAllocator.hpp"
 
 namespace Eternity
 {
@@ -10,7 +11,7 @@ namespace Eternity
         : m_PhysicalDevice(physicalDevice)
     {
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-        std::set<uint32_t> uniqueQueueFamilies = { m_PhysicalDevice.GetQueueFamilyIndex(QueueType::Graphics), m_PhysicalDevice.GetQueueFamilyIndex(QueueType::Present) };
+        std::set<uint32_t> uniqueQueueFamilies = { m_PhysicalDevice.GetQueueFamilyIndex(QueueType::Graphics), m_PhysicalDevice.GetQueueFamilyIndex(QueueType::Present), m_PhysicalDevice.GetQueueFamilyIndex(QueueType::Transfer) };
 
         float queuePriority = 1.0f;
         for (uint32_t queueFamily : uniqueQueueFamilies) 
@@ -26,8 +27,14 @@ namespace Eternity
         VkPhysicalDeviceFeatures deviceFeatures{};
         deviceFeatures.samplerAnisotropy = VK_TRUE;
 
+        // Core in Vulkan 1.2, orders uploads on transfer queue and draws on graphics queue against each other
+        VkPhysicalDeviceVulkan12Features vulkan12Features{};
+        vulkan12Features.sType              = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        vulkan12Features.timelineSemaphore  = VK_TRUE;
+
         VkDeviceCreateInfo createInfo{};
         createInfo.sType                    = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        createInfo.pNext                    = &vulkan12Features;
 
         createInfo.queueCreateInfoCount     = static_cast<uint32_t>(queueCreateInfos.size());
         createInfo.pQueueCreateInfos        = queueCreateInfos.data();
@@ -52,10 +59,15 @@ namespace Eternity
 
         vkGetDeviceQueue(m_Device, m_PhysicalDevice.GetQueueFamilyIndex(QueueType::Graphics), 0, &m_GraphicsQueue);
         vkGetDeviceQueue(m_Device, m_PhysicalDevice.GetQueueFamilyIndex(QueueType::Present), 0, &m_PresentQueue);
+        vkGetDeviceQueue(m_Device, m_PhysicalDevice.GetQueueFamilyIndex(QueueType::Transfer), 0, &m_TransferQueue);
+
+        m_Allocator = std::make_unique<MemoryAllocator>(*this);
     }
 
     Device::~Device()
     {
+        m_Allocator->ReportStats();
+        m_Allocator.reset();
         vkDestroyDevice(m_Device, nullptr);
         ET_TRACE("Device destroyed");
     }
@@ -90,6 +102,7 @@ namespace Eternity
         {
             case QueueType::Graphics:   return m_GraphicsQueue;
             case QueueType::Present:    return m_PresentQueue;
+            case QueueType::Transfer:   return m_TransferQueue;
             default:                    return VK_NULL_HANDLE;
         }
     }
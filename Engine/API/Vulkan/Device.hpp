@@ -1,10 +1,12 @@
 #pragma once
+#include <memory>
 #include <vulkan/vulkan.h>
 
 namespace Eternity
 {
     class Instance;
     class PhysicalDevice;
+    class MemoryAllocator;
     enum class QueueType;
 
     class Device
@@ -15,6 +17,9 @@ namespace Eternity
             VkDevice    m_Device;
             VkQueue     m_GraphicsQueue;
             VkQueue     m_PresentQueue;
+            VkQueue     m_TransferQueue;
+
+            std::unique_ptr<MemoryAllocator> m_Allocator;
         public:
             Device(const Instance& instance, const PhysicalDevice& physicalDevice);
             ~Device();
@@ -24,6 +29,8 @@ namespace Eternity
 
             const PhysicalDevice&   GetPhysicalDevice() const { return m_PhysicalDevice; }
             VkQueue                 GetQueue(QueueType type) const;
+            /// Device memory of buffers and images comes from here
+            MemoryAllocator&        GetAllocator() const { return *m_Allocator; }
 
             operator VkDevice() { return m_Device; }
             operator VkDevice() const { return m_Device; }
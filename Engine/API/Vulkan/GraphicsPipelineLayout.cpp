@@ -5,13 +5,15 @@
 
 namespace Eternity
 {
-    GraphicsPipelineLayout::GraphicsPipelineLayout(const Device& device, const VkDescriptorSetLayout& layout)
+    GraphicsPipelineLayout::GraphicsPipelineLayout(const Device& device, const VkDescriptorSetLayout& layout, const std::vector<VkPushConstantRange>& pushConstantRanges /* = {} */)
         : m_Device(device)
     {
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-        pipelineLayoutInfo.sType            = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipelineLayoutInfo.setLayoutCount   = 1;
-        pipelineLayoutInfo.pSetLayouts      = &layout;
+        pipelineLayoutInfo.sType                    = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount           = 1;
+        pipelineLayoutInfo.pSetLayouts              = &layout;
+        pipelineLayoutInfo.pushConstantRangeCount   = static_cast<uint32_t>(pushConstantRanges.size());
+        pipelineLayoutInfo.pPushConstantRanges      = pushConstantRanges.data();
 
         VkCheck(vkCreatePipelineLayout(m_Device, &pipelineLayoutInfo, nullptr, &m_PipelineLayout));
         ET_TRACE("Pipeline layout created");
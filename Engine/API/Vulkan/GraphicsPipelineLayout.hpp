@@ -15,7 +15,7 @@ namespace Eternity
             const Device&       m_Device;
             VkPipelineLayout    m_PipelineLayout;
         public:
-            GraphicsPipelineLayout(const Device& device, const VkDescriptorSetLayout& layout);
+            GraphicsPipelineLayout(const Device& device, const VkDescriptorSetLayout& layout, const std::vector<VkPushConstantRange>& pushConstantRanges = {});
             ~GraphicsPipelineLayout();
 
             operator VkPipelineLayout() const { return m_PipelineLayout; }
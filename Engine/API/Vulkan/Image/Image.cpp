@@ -17,10 +17,10 @@ namespace Eternity
     {
         vkDestroyImageView(m_Device, m_ImageView, nullptr);
         ET_TRACE("ImageView destroyed");
-        vkFreeMemory(m_Device, m_Memory, nullptr);
-        ET_TRACE("Free image memory");
         vkDestroyImage(m_Device, m_Image, nullptr);
         ET_TRACE("Image destroyed");
+        m_Device.GetAllocator().Free(m_Allocation);
+        ET_TRACE("Free image memory");
     }
 
     void Image::CreateImage(const VkExtent3D& extent, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties)
@@ -44,15 +44,11 @@ namespace Eternity
         VkMemoryRequirements memRequirements;
         vkGetImageMemoryRequirements(m_Device, m_Image, &memRequirements);
 
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = FindMemoryType(m_Device.GetPhysicalDevice(), memRequirements.memoryTypeBits, properties);
-
-        VkCheck(vkAllocateMemory(m_Device, &allocInfo, nullptr, &m_Memory));
+        // Optimal tiling keeps images out of buffer blocks, linear tiled ones may share with buffers
+        m_Allocation = m_Device.GetAllocator().Allocate(memRequirements, properties, tiling == VK_IMAGE_TILING_LINEAR);
         ET_TRACE("Allocate image memory");
 
-        vkBindImageMemory(m_Device, m_Image, m_Memory, 0);
+        VkCheck(vkBindImageMemory(m_Device, m_Image, m_Allocation.memory, m_Allocation.offset));
     }
 
     void Image::CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags)
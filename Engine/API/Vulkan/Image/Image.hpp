@@ -1,5 +1,6 @@
 #pragma once
 #include <vulkan/vulkan.h>
+#include "MemoryAllocator.hpp"
 
 namespace Eternity
 {
@@ -12,7 +13,7 @@ namespace Eternity
 
             VkImage                 m_Image;
             VkImageView             m_ImageView;
-            VkDeviceMemory          m_Memory;
+            MemoryAllocation        m_Allocation;
             VkExtent3D              m_Extent;
             VkFormat                m_Format;
             uint32_t                m_MipLevels = 1;
@@ -24,7 +25,7 @@ namespace Eternity
             ~Image();
 
             VkFormat          GetFormat() { return m_Format; }
-            const VkDeviceMemory&   GetImageMemory() const { return m_Memory; };
+            const VkDeviceMemory&   GetImageMemory() const { return m_Allocation.memory; };
 
             const VkImageView GetImageView() const { return m_ImageView; }
             operator VkImage() { return m_Image; }
@@ -0,0 +1,358 @@
+#include "MemoryAllocator.hpp"
+#include "Device.hpp"
+#include "PhysicalDevice.hpp"
+#include "Utils.hpp"
+#include "VkCheck.hpp"
+#include "Base.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace Eternity
+{
+    static const VkDeviceSize maxBlockSize  = 64ull << 20;
+    static const VkDeviceSize minBlockSize  = 1ull << 20;
+    // Smallest buddy range, chunk meshes and draw parameters are often tinier
+    static const VkDeviceSize minRangeSize  = 256;
+
+    static VkDeviceSize RoundUpToPowerOfTwo(VkDeviceSize value)
+    {
+        VkDeviceSize power = 1;
+        while (power < value)
+            power <<= 1;
+        return power;
+    }
+
+    BuddyAllocator::BuddyAllocator(VkDeviceSize size, VkDeviceSize minSize)
+        : m_Size(size), m_Depth(0), m_FreeBytes(size)
+    {
+        while ((minSize << m_Depth) < size)
+            m_Depth++;
+
+        m_States.assign((size_t(2) << m_Depth) - 1, NodeState::Unused);
+        m_FreeNodes.resize(m_Depth + 1);
+        m_States[0] = NodeState::Free;
+        m_FreeNodes[0].push_back(0);
+    }
+
+    uint32_t BuddyAllocator::GetNodeDepth(uint32_t node)
+    {
+        uint32_t depth = 0;
+        for (uint32_t first = 1; node + 1 >= first * 2; first *= 2)
+            depth++;
+        return depth;
+    }
+
+    void BuddyAllocator::RemoveFree(uint32_t node, uint32_t depth)
+    {
+        std::vector<uint32_t>& nodes = m_FreeNodes[depth];
+        const auto entry = std::find(nodes.begin(), nodes.end(), node);
+        *entry = nodes.back();
+        nodes.pop_back();
+    }
+
+    uint32_t BuddyAllocator::Allocate(VkDeviceSize size, VkDeviceSize alignment)
+    {
+        // Ranges are aligned to their size, so alignment only sets a lower bound on it
+        const VkDeviceSize rangeSize = RoundUpToPowerOfTwo(std::max({ size, alignment, m_Size >> m_Depth }));
+        if (rangeSize > m_Size)
+            return invalidNode;
+
+        uint32_t targetDepth = 0;
+        while ((m_Size >> targetDepth) > rangeSize)
+            targetDepth++;
+
+        // Smallest free range that fits
+        int depth = static_cast<int>(targetDepth);
+        while (depth >= 0 && m_FreeNodes[depth].empty())
+            depth--;
+        if (depth < 0)
+            return invalidNode;
+
+        uint32_t node = m_FreeNodes[depth].back();
+        m_FreeNodes[depth].pop_back();
+
+        // Split down to wanted size, right halves stay free
+        for (; static_cast<uint32_t>(depth) < targetDepth; depth++)
+        {
+            m_States[node] = NodeState::Split;
+            const uint32_t right = node * 2 + 2;
+            m_States[right] = NodeState::Free;
+            m_FreeNodes[depth + 1].push_back(right);
+            node = node * 2 + 1;
+        }
+
+        m_States[node] = NodeState::Taken;
+        m_FreeBytes -= rangeSize;
+        return node;
+    }
+
+    void BuddyAllocator::Free(uint32_t node)
+    {
+        ET_ASSERT(m_States[node] == NodeState::Taken);
+        uint32_t depth = GetNodeDepth(node);
+        m_FreeBytes += m_Size >> depth;
+
+        // Merge with free buddy as long as there is one
+        while (node != 0)
+        {
+            const uint32_t buddy = (node & 1) != 0 ? node + 1 : node - 1;
+            if (m_States[buddy] != NodeState::Free)
+                break;
+
+            RemoveFree(buddy, depth);
+            m_States[buddy] = NodeState::Unused;
+            m_States[node]  = NodeState::Unused;
+            node = (node - 1) / 2;
+            depth--;
+        }
+
+        m_States[node] = NodeState::Free;
+        m_FreeNodes[depth].push_back(node);
+    }
+
+    VkDeviceSize BuddyAllocator::GetOffset(uint32_t node) const
+    {
+        const uint32_t depth = GetNodeDepth(node);
+        const uint32_t first = (1u << depth) - 1;
+        return (node - first) * (m_Size >> depth);
+    }
+
+    VkDeviceSize BuddyAllocator::GetLargestFree() const
+    {
+        for (uint32_t depth = 0; depth <= m_Depth; depth++)
+            if (!m_FreeNodes[depth].empty())
+                return m_Size >> depth;
+        return 0;
+    }
+
+    RangeAllocator::RangeAllocator(uint32_t capacity /* = 0 */)
+        : m_Capacity(0), m_FreeCount(0)
+    {
+        Grow(capacity);
+    }
+
+    uint32_t RangeAllocator::Allocate(uint32_t size)
+    {
+        for (auto range = m_FreeRanges.begin(); range != m_FreeRanges.end(); ++range)
+        {
+            if (range->second < size)
+                continue;
+
+            const uint32_t offset = range->first;
+            const uint32_t rest = range->second - size;
+            m_FreeRanges.erase(range);
+            if (rest != 0)
+                m_FreeRanges.emplace(offset + size, rest);
+
+            m_FreeCount -= size;
+            return offset;
+        }
+        return invalidOffset;
+    }
+
+    void RangeAllocator::Free(uint32_t offset, uint32_t size)
+    {
+        if (size == 0)
+            return;
+        m_FreeCount += size;
+
+        auto next = m_FreeRanges.lower_bound(offset);
+        if (next != m_FreeRanges.end() && offset + size == next->first)
+        {
+            size += next->second;
+            next = m_FreeRanges.erase(next);
+        }
+
+        if (next != m_FreeRanges.begin())
+        {
+            const auto previous = std::prev(next);
+            if (previous->first + previous->second == offset)
+            {
+                previous->second += size;
+                return;
+            }
+        }
+        m_FreeRanges.emplace_hint(next, offset, size);
+    }
+
+    void RangeAllocator::Grow(uint32_t capacity)
+    {
+        if (capacity <= m_Capacity)
+            return;
+
+        const uint32_t offset = m_Capacity;
+        m_Capacity = capacity;
+        Free(offset, capacity - offset);
+    }
+
+    uint32_t RangeAllocator::GetLargestFree() const
+    {
+        uint32_t largest = 0;
+        for (const auto& range : m_FreeRanges)
+            largest = std::max(largest, range.second);
+        return largest;
+    }
+
+    MemoryAllocator::MemoryAllocator(const Device& device)
+        : m_Device(device)
+    {
+        vkGetPhysicalDeviceMemoryProperties(m_Device.GetPhysicalDevice(), &m_MemoryProperties);
+    }
+
+    MemoryAllocator::~MemoryAllocator()
+    {
+        if (m_Stats.allocations != 0)
+            ET_WARN("Device memory freed with", m_Stats.allocations, "allocations still alive");
+
+        for (Pool& pool : m_Pools)
+            for (const std::unique_ptr<Block>& block : pool.blocks)
+                if (block != nullptr)
+                    vkFreeMemory(m_Device, block->memory, nullptr);
+    }
+
+    uint32_t MemoryAllocator::GetPool(uint32_t memoryType, bool linear)
+    {
+        for (uint32_t i = 0; i < m_Pools.size(); i++)
+            if (m_Pools[i].memoryType == memoryType && m_Pools[i].linear == linear)
+                return i;
+
+        // Small heaps, like host visible device memory, would be taken up by few blocks
+        const VkDeviceSize heapSize = m_MemoryProperties.memoryHeaps[m_MemoryProperties.memoryTypes[memoryType].heapIndex].size;
+        VkDeviceSize blockSize = maxBlockSize;
+        while (blockSize > minBlockSize && blockSize > heapSize / 8)
+            blockSize >>= 1;
+
+        m_Pools.push_back({ memoryType, linear, blockSize, {} });
+        return static_cast<uint32_t>(m_Pools.size() - 1);
+    }
+
+    VkDeviceMemory MemoryAllocator::AllocateDeviceMemory(VkDeviceSize size, uint32_t memoryType, void** mapped)
+    {
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType             = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize    = size;
+        allocInfo.memoryTypeIndex   = memoryType;
+
+        VkDeviceMemory memory;
+        VkCheck(vkAllocateMemory(m_Device, &allocInfo, nullptr, &memory));
+
+        *mapped = nullptr;
+        if ((m_MemoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0)
+            VkCheck(vkMapMemory(m_Device, memory, 0, VK_WHOLE_SIZE, 0, mapped));
+
+        m_Stats.allocatedBytes += size;
+        m_Stats.deviceAllocations++;
+        return memory;
+    }
+
+    void MemoryAllocator::FreeDeviceMemory(VkDeviceMemory memory, VkDeviceSize size)
+    {
+        vkFreeMemory(m_Device, memory, nullptr);
+        m_Stats.allocatedBytes -= size;
+        m_Stats.deviceAllocations--;
+    }
+
+    MemoryAllocation MemoryAllocator::Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear)
+    {
+        const uint32_t memoryType = FindMemoryType(m_Device.GetPhysicalDevice(), requirements.memoryTypeBits, properties);
+
+        MemoryAllocation allocation;
+        allocation.size = requirements.size;
+        allocation.pool = GetPool(memoryType, linear);
+        Pool& pool = m_Pools[allocation.pool];
+
+        m_Stats.usedBytes += requirements.size;
+        m_Stats.allocations++;
+
+        if (requirements.size > pool.blockSize / 2)
+        {
+            allocation.memory = AllocateDeviceMemory(requirements.size, memoryType, &allocation.mapped);
+            return allocation;
+        }
+
+        uint32_t blockIndex = 0;
+        for (; blockIndex < pool.blocks.size(); blockIndex++)
+        {
+            Block* block = pool.blocks[blockIndex].get();
+            if (block == nullptr)
+                continue;
+            allocation.node = block->ranges.Allocate(requirements.size, requirements.alignment);
+            if (allocation.node != BuddyAllocator::invalidNode)
+                break;
+        }
+
+        if (blockIndex == pool.blocks.size())
+        {
+            // Every block is full, new one takes first empty slot
+            blockIndex = 0;
+            while (blockIndex < pool.blocks.size() && pool.blocks[blockIndex] != nullptr)
+                blockIndex++;
+            if (blockIndex == pool.blocks.size())
+                pool.blocks.emplace_back();
+
+            void* mapped;
+            const VkDeviceMemory memory = AllocateDeviceMemory(pool.blockSize, memoryType, &mapped);
+            pool.blocks[blockIndex].reset(new Block{ memory, mapped, BuddyAllocator(pool.blockSize, minRangeSize) });
+            allocation.node = pool.blocks[blockIndex]->ranges.Allocate(requirements.size, requirements.alignment);
+        }
+
+        const Block& block = *pool.blocks[blockIndex];
+        allocation.block    = blockIndex;
+        allocation.memory   = block.memory;
+        allocation.offset   = block.ranges.GetOffset(allocation.node);
+        if (block.mapped != nullptr)
+            allocation.mapped = static_cast<char*>(block.mapped) + allocation.offset;
+
+        m_Stats.roundingBytes += block.ranges.GetNodeSize(allocation.node) - requirements.size;
+        return allocation;
+    }
+
+    void MemoryAllocator::Free(const MemoryAllocation& allocation)
+    {
+        if (allocation.memory == VK_NULL_HANDLE)
+            return;
+
+        m_Stats.usedBytes -= allocation.size;
+        m_Stats.allocations--;
+
+        Pool& pool = m_Pools[allocation.pool];
+        if (allocation.node == BuddyAllocator::invalidNode)
+        {
+            FreeDeviceMemory(allocation.memory, allocation.size);
+            return;
+        }
+
+        std::unique_ptr<Block>& block = pool.blocks[allocation.block];
+        m_Stats.roundingBytes -= block->ranges.GetNodeSize(allocation.node) - allocation.size;
+        block->ranges.Free(allocation.node);
+
+        // Last empty block is kept, so an allocation freed and made again doesn't go to the driver each time
+        if (block->ranges.IsEmpty())
+        {
+            const size_t liveBlocks = std::count_if(pool.blocks.begin(), pool.blocks.end(), [](const std::unique_ptr<Block>& other) { return other != nullptr; });
+            if (liveBlocks > 1)
+            {
+                FreeDeviceMemory(block->memory, pool.blockSize);
+                block.reset();
+            }
+        }
+    }
+
+    MemoryStats MemoryAllocator::GetStats() const
+    {
+        MemoryStats stats = m_Stats;
+        for (const Pool& pool : m_Pools)
+            for (const std::unique_ptr<Block>& block : pool.blocks)
+                if (block != nullptr)
+                    stats.fragmentedBytes += block->ranges.GetFreeBytes() - block->ranges.GetLargestFree();
+        return stats;
+    }
+
+    void MemoryAllocator::ReportStats() const
+    {
+        const MemoryStats stats = GetStats();
+        ET_INFO("Device memory:", stats.allocatedBytes, "bytes in", stats.deviceAllocations, "device allocations,", stats.usedBytes, "bytes used by", stats.allocations, "allocations");
+        ET_INFO("Device memory lost:", stats.roundingBytes, "bytes to range rounding,", stats.fragmentedBytes, "free bytes outside largest free range of their block");
+    }
+} // namespace Eternity
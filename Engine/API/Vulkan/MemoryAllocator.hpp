@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace Eternity
+{
+    class Device;
+
+    /// Buddy sub-allocation of a power of two sized range. Ranges are split in halves down to minimum size and
+    /// freed halves merge back with their buddy, so every range is aligned to its own size
+    class BuddyAllocator
+    {
+        private:
+            enum class NodeState : uint8_t { Unused, Free, Split, Taken };
+
+            VkDeviceSize                        m_Size;
+            uint32_t                            m_Depth;        // levels of halving from whole range down to minimum size
+            std::vector<NodeState>              m_States;       // implicit binary tree, children of node i are 2i + 1 and 2i + 2
+            std::vector<std::vector<uint32_t>>  m_FreeNodes;    // by tree depth
+            VkDeviceSize                        m_FreeBytes;
+
+            static uint32_t GetNodeDepth(uint32_t node);
+            void RemoveFree(uint32_t node, uint32_t depth);
+        public:
+            static const uint32_t invalidNode = ~0u;
+
+            /// Size and minSize must be powers of two
+            BuddyAllocator(VkDeviceSize size, VkDeviceSize minSize);
+
+            /// Node of a range of at least size bytes aligned to alignment, invalidNode if none is free
+            uint32_t Allocate(VkDeviceSize size, VkDeviceSize alignment);
+            void Free(uint32_t node);
+
+            VkDeviceSize GetOffset(uint32_t node) const;
+            VkDeviceSize GetNodeSize(uint32_t node) const { return m_Size >> GetNodeDepth(node); }
+            VkDeviceSize GetFreeBytes() const { return m_FreeBytes; }
+            /// Biggest range a single allocation could still get
+            VkDeviceSize GetLargestFree() const;
+            bool IsEmpty() const { return m_FreeBytes == m_Size; }
+    };
+
+    /// First fit allocation of element ranges in [0, capacity). Ranges keep their exact size, freed ones merge with
+    /// free neighbors. Suits ranges inside one buffer, where power of two rounding of BuddyAllocator would waste too much
+    class RangeAllocator
+    {
+        private:
+            std::map<uint32_t, uint32_t>    m_FreeRanges;   // offset to size, never adjacent
+            uint32_t                        m_Capacity;
+            uint32_t                        m_FreeCount;
+        public:
+            static const uint32_t invalidOffset = ~0u;
+
+            RangeAllocator(uint32_t capacity = 0);
+
+            /// Lowest offset with size free elements, invalidOffset if there's none
+            uint32_t Allocate(uint32_t size);
+            void Free(uint32_t offset, uint32_t size);
+            /// New elements at the end are free
+            void Grow(uint32_t capacity);
+
+            uint32_t GetCapacity() const { return m_Capacity; }
+            uint32_t GetFreeCount() const { return m_FreeCount; }
+            uint32_t GetLargestFree() const;
+    };
+
+    /// Range of device memory handed out by MemoryAllocator
+    struct MemoryAllocation
+    {
+        VkDeviceMemory  memory  = VK_NULL_HANDLE;
+        VkDeviceSize    offset  = 0;
+        VkDeviceSize    size    = 0;        // as requested
+        void*           mapped  = nullptr;  // host address of offset, only for host visible memory
+        uint32_t        pool    = 0;
+        uint32_t        block   = 0;
+        uint32_t        node    = BuddyAllocator::invalidNode;  // invalidNode when memory is dedicated to allocation
+    };
+
+    struct MemoryStats
+    {
+        VkDeviceSize    allocatedBytes      = 0;    // device memory held, blocks and dedicated allocations
+        VkDeviceSize    usedBytes           = 0;    // requested by live allocations
+        VkDeviceSize    roundingBytes       = 0;    // lost rounding allocations up to buddy range size
+        VkDeviceSize    fragmentedBytes     = 0;    // free bytes of blocks outside largest free range of their block
+        uint32_t        deviceAllocations   = 0;    // live vkAllocateMemory results, bounded by maxMemoryAllocationCount
+        uint32_t        allocations         = 0;
+    };
+
+    /// Hands out device memory from big blocks, one set of blocks per memory type and resource kind, so vkAllocateMemory
+    /// only runs when blocks fill up. Blocks are split by BuddyAllocator. Host visible blocks stay mapped while they live.
+    /// Requests over half a block get memory of their own. Not thread safe, resources are created on render thread
+    class MemoryAllocator
+    {
+        private:
+            struct Block
+            {
+                VkDeviceMemory  memory;
+                void*           mapped;
+                BuddyAllocator  ranges;
+            };
+
+            struct Pool
+            {
+                uint32_t                            memoryType;
+                bool                                linear;
+                VkDeviceSize                        blockSize;
+                std::vector<std::unique_ptr<Block>> blocks;     // freed blocks leave empty slot, so indices stay valid
+            };
+
+            const Device&                       m_Device;
+            VkPhysicalDeviceMemoryProperties    m_MemoryProperties;
+            std::vector<Pool>                   m_Pools;
+            MemoryStats                         m_Stats;        // fragmentedBytes is computed on request
+
+            uint32_t        GetPool(uint32_t memoryType, bool linear);
+            VkDeviceMemory  AllocateDeviceMemory(VkDeviceSize size, uint32_t memoryType, void** mapped);
+            void            FreeDeviceMemory(VkDeviceMemory memory, VkDeviceSize size);
+        public:
+            MemoryAllocator(const Device& device);
+            ~MemoryAllocator();
+
+            /// Linear resources (buffers) and optimal tiling images never share a block, so bufferImageGranularity
+            /// doesn't have to be kept between neighbors
+            MemoryAllocation    Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear);
+            void                Free(const MemoryAllocation& allocation);
+
+            MemoryStats GetStats() const;
+            void        ReportStats() const;
+    };
+} // namespace Eternity
@@ -5,6 +5,10 @@
 #include "Surface.hpp"
 #include "Base.hpp"
 
+#ifndef ET_TRANSFER_QUEUE
+#define ET_TRANSFER_QUEUE 1
+#endif
+
 namespace Eternity
 {
     const std::vector<const char*> deviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
@@ -32,8 +36,14 @@ namespace Eternity
         auto indices = FindQueueFamilies(m_PhysicalDevice);
         m_GraphicsFamily    = indices.graphicsFamily.value();
         m_PresentFamily     = indices.presentFamily.value();
+        m_TransferFamily    = indices.transferFamily.value_or(m_GraphicsFamily);
+#if !ET_TRANSFER_QUEUE
+        m_TransferFamily    = m_GraphicsFamily;
+#endif
 
         ET_TRACE("Physical device selected");
+        if (HasTransferFamily())
+            ET_TRACE("Uploads on transfer queue family", m_TransferFamily);
     }
 
     bool PhysicalDevice::CheckDeviceExtensionSupport(VkPhysicalDevice device) 
@@ -80,6 +90,17 @@ namespace Eternity
             i++;
         }
 
+        // DMA engines usually show up as families that can only transfer
+        for (uint32_t family = 0; family < queueFamilyCount; family++)
+        {
+            const VkQueueFlags flags = queueFamilies[family].queueFlags;
+            if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+            {
+                indices.transferFamily = family;
+                break;
+            }
+        }
+
         return indices;
     }
 
@@ -135,10 +156,18 @@ namespace Eternity
         {
             case QueueType::Graphics:   return m_GraphicsFamily;
             case QueueType::Present:    return m_PresentFamily;
+            case QueueType::Transfer:   return m_TransferFamily;
             default:                    return 0;
         }
     }
 
+    std::vector<uint32_t> PhysicalDevice::GetUploadQueueFamilies() const
+    {
+        if (HasTransferFamily())
+            return { m_GraphicsFamily, m_TransferFamily };
+        return { m_GraphicsFamily };
+    }
+
     const PhysicalDevice::SwapchainSupportDetails PhysicalDevice::GetSwapchainSupportDetails() const { return QuerySwapchainSupport(m_PhysicalDevice); }
 
     const std::vector<const char*>&     PhysicalDevice::GetDeviceExtensions() const { return deviceExtensions; };
@@ -8,7 +8,8 @@ namespace Eternity
     enum class QueueType
     {
         Graphics,
-        Present
+        Present,
+        Transfer    // graphics family when device has no transfer only one
     };
 
     class Instance;
@@ -21,6 +22,7 @@ namespace Eternity
             {
                 std::optional<uint32_t> graphicsFamily;
                 std::optional<uint32_t> presentFamily;
+                std::optional<uint32_t> transferFamily;     // without graphics and compute, optional
 
                 bool isComplete() 
                 {
@@ -40,6 +42,7 @@ namespace Eternity
 
             uint32_t            m_GraphicsFamily;
             uint32_t            m_PresentFamily;
+            uint32_t            m_TransferFamily;
 
             bool                                CheckDeviceExtensionSupport(VkPhysicalDevice device);
             QueueFamilyIndices                  FindQueueFamilies(VkPhysicalDevice device);
@@ -50,6 +53,10 @@ namespace Eternity
             ~PhysicalDevice() = default;
 
             const uint32_t                      GetQueueFamilyIndex(QueueType type) const;
+            /// Uploads run on a queue family of their own
+            bool                                HasTransferFamily() const { return m_TransferFamily != m_GraphicsFamily; }
+            /// Families using buffers uploads write, graphics family alone without transfer family
+            std::vector<uint32_t>               GetUploadQueueFamilies() const;
             const SwapchainSupportDetails       GetSwapchainSupportDetails() const;
             const std::vector<const char*>&     GetDeviceExtensions() const;
             const Surface&                      GetSurface() const;
@@ -0,0 +1,121 @@
+#include "Base.hpp"
+#include "MappedFile.hpp"
+
+#if defined(ET_PLATFORM_WINDOWS)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace Eternity
+{
+    MappedFile::~MappedFile()
+    {
+        Close();
+    }
+
+#if defined(ET_PLATFORM_WINDOWS)
+    bool MappedFile::Open(const std::string& path)
+    {
+        Close();
+
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        m_File = file;
+        return Remap();
+    }
+
+    bool MappedFile::Remap()
+    {
+        if (m_Data != nullptr)
+            UnmapViewOfFile(m_Data);
+        if (m_Mapping != nullptr)
+            CloseHandle(m_Mapping);
+        m_Data      = nullptr;
+        m_Mapping   = nullptr;
+        m_Size      = 0;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_File, &size))
+            return false;
+        // Empty files can't be mapped
+        if (size.QuadPart == 0)
+            return true;
+
+        m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_Mapping == nullptr)
+            return false;
+
+        m_Data = static_cast<const uint8_t*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+        m_Size = m_Data != nullptr ? static_cast<size_t>(size.QuadPart) : 0;
+        return m_Data != nullptr;
+    }
+
+    void MappedFile::Close()
+    {
+        if (m_Data != nullptr)
+            UnmapViewOfFile(m_Data);
+        if (m_Mapping != nullptr)
+            CloseHandle(m_Mapping);
+        if (m_File != nullptr)
+            CloseHandle(m_File);
+
+        m_Data      = nullptr;
+        m_Mapping   = nullptr;
+        m_File      = nullptr;
+        m_Size      = 0;
+    }
+#else
+    bool MappedFile::Open(const std::string& path)
+    {
+        Close();
+
+        m_File = open(path.c_str(), O_RDONLY);
+        if (m_File < 0)
+            return false;
+
+        return Remap();
+    }
+
+    bool MappedFile::Remap()
+    {
+        if (m_Data != nullptr)
+            munmap(const_cast<uint8_t*>(m_Data), m_Size);
+        m_Data = nullptr;
+        m_Size = 0;
+
+        struct stat info;
+        if (fstat(m_File, &info) != 0)
+            return false;
+        // Empty files can't be mapped
+        if (info.st_size == 0)
+            return true;
+
+        void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, m_File, 0);
+        if (data == MAP_FAILED)
+            return false;
+
+        m_Data = static_cast<const uint8_t*>(data);
+        m_Size = static_cast<size_t>(info.st_size);
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (m_Data != nullptr)
+            munmap(const_cast<uint8_t*>(m_Data), m_Size);
+        if (m_File >= 0)
+            close(m_File);
+
+        m_Data = nullptr;
+        m_File = -1;
+        m_Size = 0;
+    }
+#endif
+} // namespace Eternity
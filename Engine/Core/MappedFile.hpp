@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "PlatformDetection.hpp"
+
+namespace Eternity
+{
+    /// Read-only memory mapping of a whole file. Writes made to the file through other handles
+    /// become visible in the mapping, Remap picks up growth of the file
+    class MappedFile
+    {
+        private:
+            const uint8_t*  m_Data = nullptr;
+            size_t          m_Size = 0;
+        #if defined(ET_PLATFORM_WINDOWS)
+            void*           m_File      = nullptr;
+            void*           m_Mapping   = nullptr;
+        #else
+            int             m_File      = -1;
+        #endif
+        public:
+            MappedFile() = default;
+            ~MappedFile();
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            /// Map current contents of file, returns false if it can't be opened
+            bool Open(const std::string& path);
+            /// Map file again at its current size
+            bool Remap();
+            void Close();
+
+            const uint8_t*  GetData() const { return m_Data; }
+            size_t          GetSize() const { return m_Size; }
+    };
+} // namespace Eternity
@@ -0,0 +1,195 @@
+#include "Frustum.hpp"
+#include "Base.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <glm/gtc/matrix_transform.hpp>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+    #include <immintrin.h>
+#endif
+
+// One SIMD register of floats and comparison masks over it, boxes that don't fill a register are tested one by one
+namespace
+{
+#if defined(__AVX2__)
+    const size_t width = 8;
+    using vfloat    = __m256;
+
+    inline vfloat   Set(float a)                    { return _mm256_set1_ps(a); }
+    inline vfloat   Load(const float* a)            { return _mm256_loadu_ps(a); }
+    inline vfloat   Add(vfloat a, vfloat b)         { return _mm256_add_ps(a, b); }
+    inline vfloat   Mul(vfloat a, vfloat b)         { return _mm256_mul_ps(a, b); }
+    inline vfloat   And(vfloat a, vfloat b)         { return _mm256_and_ps(a, b); }
+    inline vfloat   NotNegative(vfloat a)           { return _mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_GE_OQ); }
+    inline int      Mask(vfloat a)                  { return _mm256_movemask_ps(a); }
+#elif defined(__SSE4_1__)
+    const size_t width = 4;
+    using vfloat    = __m128;
+
+    inline vfloat   Set(float a)                    { return _mm_set1_ps(a); }
+    inline vfloat   Load(const float* a)            { return _mm_loadu_ps(a); }
+    inline vfloat   Add(vfloat a, vfloat b)         { return _mm_add_ps(a, b); }
+    inline vfloat   Mul(vfloat a, vfloat b)         { return _mm_mul_ps(a, b); }
+    inline vfloat   And(vfloat a, vfloat b)         { return _mm_and_ps(a, b); }
+    inline vfloat   NotNegative(vfloat a)           { return _mm_cmpge_ps(a, _mm_setzero_ps()); }
+    inline int      Mask(vfloat a)                  { return _mm_movemask_ps(a); }
+#else
+    const size_t width = 1;
+#endif
+}
+
+namespace Eternity
+{
+    void BoundsList::Push(const glm::vec3& min, const glm::vec3& max)
+    {
+        minX.push_back(min.x);
+        minY.push_back(min.y);
+        minZ.push_back(min.z);
+        maxX.push_back(max.x);
+        maxY.push_back(max.y);
+        maxZ.push_back(max.z);
+    }
+
+    void BoundsList::Set(size_t index, const glm::vec3& min, const glm::vec3& max)
+    {
+        minX[index] = min.x;
+        minY[index] = min.y;
+        minZ[index] = min.z;
+        maxX[index] = max.x;
+        maxY[index] = max.y;
+        maxZ[index] = max.z;
+    }
+
+    void BoundsList::Erase(size_t index)
+    {
+        for (std::vector<float>* list : { &minX, &minY, &minZ, &maxX, &maxY, &maxZ })
+            list->erase(list->begin() + index);
+    }
+
+    Frustum::Frustum()
+    {
+        m_Planes.fill(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    }
+
+    Frustum::Frustum(const glm::mat4& viewProjection)
+    {
+        // Clip space point is inside when -w <= x <= w, -w <= y <= w and 0 <= z <= w,
+        // each bound is a plane made of matrix rows. Planes aren't normalized, only sign of distance is used
+        auto row = [&](int i) { return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]); };
+
+        m_Planes[0] = row(3) + row(0);
+        m_Planes[1] = row(3) - row(0);
+        m_Planes[2] = row(3) + row(1);
+        m_Planes[3] = row(3) - row(1);
+        m_Planes[4] = row(2);
+        m_Planes[5] = row(3) - row(2);
+    }
+
+    bool Frustum::IsVisible(const glm::vec3& min, const glm::vec3& max) const
+    {
+        for (const glm::vec4& plane : m_Planes)
+        {
+            // Box corner furthest along plane normal
+            const glm::vec3 corner(plane.x >= 0.0f ? max.x : min.x, plane.y >= 0.0f ? max.y : min.y, plane.z >= 0.0f ? max.z : min.z);
+            if (plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    void Frustum::Cull(const BoundsList& bounds, uint8_t* visible) const
+    {
+        const size_t count = bounds.Size();
+        size_t i = 0;
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+        // Corner furthest along normal takes max or min on each axis by sign of normal, same for every box
+        const float* cornerX[6];
+        const float* cornerY[6];
+        const float* cornerZ[6];
+        vfloat normalX[6], normalY[6], normalZ[6], distance[6];
+        for (int p = 0; p < 6; p++)
+        {
+            const glm::vec4& plane = m_Planes[p];
+            cornerX[p]  = plane.x >= 0.0f ? bounds.maxX.data() : bounds.minX.data();
+            cornerY[p]  = plane.y >= 0.0f ? bounds.maxY.data() : bounds.minY.data();
+            cornerZ[p]  = plane.z >= 0.0f ? bounds.maxZ.data() : bounds.minZ.data();
+            normalX[p]  = Set(plane.x);
+            normalY[p]  = Set(plane.y);
+            normalZ[p]  = Set(plane.z);
+            distance[p] = Set(plane.w);
+        }
+
+        for (; i + width <= count; i += width)
+        {
+            vfloat inside = NotNegative(Set(0.0f));
+            for (int p = 0; p < 6; p++)
+            {
+                const vfloat along = Add(Add(Mul(normalX[p], Load(cornerX[p] + i)), Mul(normalY[p], Load(cornerY[p] + i))),
+                                         Add(Mul(normalZ[p], Load(cornerZ[p] + i)), distance[p]));
+                inside = And(inside, NotNegative(along));
+            }
+
+            const int mask = Mask(inside);
+            for (size_t k = 0; k < width; k++)
+                visible[i + k] = static_cast<uint8_t>((mask >> k) & 1);
+        }
+#endif
+
+        for (; i < count; i++)
+        {
+            const glm::vec3 min(bounds.minX[i], bounds.minY[i], bounds.minZ[i]);
+            const glm::vec3 max(bounds.maxX[i], bounds.maxY[i], bounds.maxZ[i]);
+            visible[i] = IsVisible(min, max) ? 1 : 0;
+        }
+    }
+
+    void Frustum::ReportThroughput(size_t boxCount /* = 10000 */)
+    {
+        // Chunk sized boxes in a flat square around camera, like a loaded world seen from its middle
+        const int side = static_cast<int>(std::sqrt(static_cast<double>(boxCount)));
+        const float boxSize = 6.0f;
+        BoundsList bounds;
+        for (int x = 0; x < side; x++)
+            for (int z = 0; z < side; z++)
+            {
+                const glm::vec3 min((x - side / 2) * boxSize, 0.0f, (z - side / 2) * boxSize);
+                bounds.Push(min, min + glm::vec3(boxSize));
+            }
+
+        std::mt19937 random(1337);
+        std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+        const glm::mat4 proj = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 1000.0f);
+
+        using Clock = std::chrono::high_resolution_clock;
+        const int repeats = 200;
+        std::vector<uint8_t> visible(bounds.Size());
+        size_t visibleCount = 0;
+        double batchedSeconds = 0.0;
+        double singleSeconds = 0.0;
+        for (int r = 0; r < repeats; r++)
+        {
+            const float yaw = angle(random);
+            const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 3.0f, 0.0f), glm::vec3(std::cos(yaw), 2.5f, std::sin(yaw)), glm::vec3(0.0f, 1.0f, 0.0f));
+            const Frustum frustum(proj * view);
+
+            auto start = Clock::now();
+            frustum.Cull(bounds, visible.data());
+            batchedSeconds += std::chrono::duration<double, std::chrono::seconds::period>(Clock::now() - start).count();
+
+            start = Clock::now();
+            for (size_t i = 0; i < bounds.Size(); i++)
+            {
+                const bool single = frustum.IsVisible({ bounds.minX[i], bounds.minY[i], bounds.minZ[i] }, { bounds.maxX[i], bounds.maxY[i], bounds.maxZ[i] });
+                ET_ASSERT(single == (visible[i] != 0));
+                visibleCount += single ? 1 : 0;
+            }
+            singleSeconds += std::chrono::duration<double, std::chrono::seconds::period>(Clock::now() - start).count();
+        }
+
+        ET_INFO("Frustum culling: batch width", width, ",", bounds.Size(), "boxes,", visibleCount / repeats, "visible on average");
+        ET_INFO("Frustum culling batched:", batchedSeconds * 1e6 / repeats, "us per frame, one box at a time:", singleSeconds * 1e6 / repeats, "us per frame");
+    }
+}
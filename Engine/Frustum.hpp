@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Eternity
+{
+    /// Axis aligned boxes kept as structure of arrays, so culling tests several boxes with one instruction
+    class BoundsList
+    {
+        public:
+            std::vector<float>  minX, minY, minZ;
+            std::vector<float>  maxX, maxY, maxZ;
+
+            size_t Size() const { return minX.size(); }
+            void Push(const glm::vec3& min, const glm::vec3& max);
+            void Set(size_t index, const glm::vec3& min, const glm::vec3& max);
+            void Erase(size_t index);
+    };
+
+    /// Six planes bounding what camera sees, taken from view projection matrix
+    class Frustum
+    {
+        private:
+            std::array<glm::vec4, 6>    m_Planes;   // normal (xyz) pointing inside, distance (w)
+        public:
+            /// Frustum that contains everything
+            Frustum();
+            /// Planes of clip space volume with depth from 0 to 1
+            explicit Frustum(const glm::mat4& viewProjection);
+
+            /// Box at least partly inside. Boxes near frustum corners may pass without being inside
+            bool IsVisible(const glm::vec3& min, const glm::vec3& max) const;
+            /// Writes 1 to visible for every box at least partly inside, 0 otherwise
+            void Cull(const BoundsList& bounds, uint8_t* visible) const;
+
+            static void ReportThroughput(size_t boxCount = 10000);
+    };
+}
@@ -13,10 +13,30 @@
 #include "Buffer.hpp"
 #include "UniformBuffer.hpp"
 
+/// Voxel vertex packed into 8 bytes. Position is an integer block corner relative to Renderable::origin,
+/// texture coordinates are derived from position and normal in vertex shader
 struct Vertex 
 {
-    glm::vec3 pos;
-    glm::vec2 texCoord;
+    uint32_t data;          // x, y, z (7 bits each), normal index (3 bits), corner id (2 bits)
+    uint32_t material;      // atlas tile index (8 bits), ambient occlusion (2 bits, 3 = unoccluded), sky light (4 bits), block light (4 bits), rest reserved
+
+    static const uint32_t maxCoordinate = 127;
+
+    /// Light is packed voxel light, sky light in low nibble and block light in high nibble
+    static Vertex Pack(const glm::ivec3& pos, uint32_t normal, uint32_t corner, uint32_t tile, uint32_t occlusion = 3, uint32_t light = 15)
+    {
+        Vertex vertex;
+        vertex.data     = uint32_t(pos.x) | (uint32_t(pos.y) << 7) | (uint32_t(pos.z) << 14) | (normal << 21) | (corner << 24);
+        vertex.material = tile | (occlusion << 8) | (light << 10);
+        return vertex;
+    }
+
+    glm::ivec3  GetPosition() const { return { data & 127u, (data >> 7) & 127u, (data >> 14) & 127u }; }
+    uint32_t    GetNormal() const   { return (data >> 21) & 7u; }
+    uint32_t    GetCorner() const   { return (data >> 24) & 3u; }
+    uint32_t    GetTile() const     { return material & 255u; }
+    uint32_t    GetOcclusion() const { return (material >> 8) & 3u; }
+    uint32_t    GetLight() const    { return (material >> 10) & 255u; }
 
     static std::vector<VkVertexInputBindingDescription> getBindingDescription() 
     {
@@ -35,20 +55,20 @@ struct Vertex
         attributeDescriptions[0] = {};
         attributeDescriptions[0].binding = 0;
         attributeDescriptions[0].location = 0;
-        attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-        attributeDescriptions[0].offset = offsetof(Vertex, pos);
+        attributeDescriptions[0].format = VK_FORMAT_R32_UINT;
+        attributeDescriptions[0].offset = offsetof(Vertex, data);
         attributeDescriptions[1] = {};
         attributeDescriptions[1].binding = 0;
         attributeDescriptions[1].location = 1;
-        attributeDescriptions[1].format = VK_FORMAT_R32G32_SFLOAT;
-        attributeDescriptions[1].offset = offsetof(Vertex, texCoord);
+        attributeDescriptions[1].format = VK_FORMAT_R32_UINT;
+        attributeDescriptions[1].offset = offsetof(Vertex, material);
 
         return attributeDescriptions;
     }
 
     bool operator==(const Vertex& other) const 
     {
-        return pos == other.pos && texCoord == other.texCoord;
+        return data == other.data && material == other.material;
     }
 };
 
@@ -57,11 +77,17 @@ namespace std
     template<> struct hash<Vertex> 
     {
         size_t operator()(Vertex const& vertex) const {
-            return ((hash<glm::vec3>()(vertex.pos)) >> 1) ^ (hash<glm::vec2>()(vertex.texCoord) << 1);
+            return hash<uint64_t>()((static_cast<uint64_t>(vertex.material) << 32) | vertex.data);
         }
     };
 }
 
+/// Per draw data, pushed as push constants
+struct DrawConstants
+{
+    alignas(16) glm::vec4 origin;   // world position of vertex coordinate (0, 0, 0)
+};
+
 struct UBOMatrices 
 {
     alignas(16) glm::mat4 model;
@@ -71,17 +97,30 @@ struct UBOMatrices
 
 namespace Eternity
 {
+    struct MeshRange;
+
     class Renderable
     {
         public:
             std::vector<Vertex>                             vertices;
             std::vector<uint32_t>                           indices;
+            glm::vec3                                       origin = glm::vec3(0.0f);   // added to every vertex position
+            // World space box around geometry, used for frustum culling. Default one is never culled
+            glm::vec3                                       boundsMin = glm::vec3(-1e30f);
+            glm::vec3                                       boundsMax = glm::vec3(1e30f);
+            bool                                            occluded  = false;          // known to be hidden, not drawn
+            // Models with same nonzero key have identical vertices and indices, they share one mesh range
+            // and each is drawn at its own origin. It's trusted as it is, so it has to be a strong hash
+            uint64_t                                        meshKey   = 0;
 
-            std::shared_ptr<Buffer>                         m_VertexBuffer;
-            std::shared_ptr<Buffer>                         m_IndexBuffer;
+            // First vertex and index changed since last upload, LoadModel rewrites ranges only from here on
+            // while they still fit. Left at 0 everything is uploaded
+            size_t                                          dirtyVertexOffset   = 0;
+            size_t                                          dirtyIndexOffset    = 0;
 
-            std::vector<std::shared_ptr<UniformBuffer>>     m_UniformBuffers;
+            std::shared_ptr<MeshRange>                      m_Mesh;             // in geometry buffer of VulkanApp, capacity may exceed vertices
+            uint64_t                                        m_UploadedMeshKey = 0;  // meshKey mesh was offered for sharing under
 
-            size_t bind;
+            std::vector<std::shared_ptr<UniformBuffer>>     m_UniformBuffers;
     };
 }
\ No newline at end of file
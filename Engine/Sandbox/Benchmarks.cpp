@@ -0,0 +1,97 @@
+#include "Benchmarks.hpp"
+#include "Base.hpp"
+#include "ChunkMap.hpp"
+#include "World.hpp"
+#include "../Frustum.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <unordered_map>
+
+/// Time inserts, hit and miss lookups and erases of chunk coordinates in ChunkMap and std::unordered_map
+static void ReportChunkMapThroughput()
+{
+    // Coordinates of a streamed area 64 x 8 x 64 chunks around origin, looked up in random order
+    std::vector<glm::ivec3> coords;
+    for (int x = -32; x < 32; x++)
+        for (int y = 0; y < 8; y++)
+            for (int z = -32; z < 32; z++)
+                coords.push_back({ x, y, z });
+    std::mt19937 random(7);
+    std::shuffle(coords.begin(), coords.end(), random);
+
+    std::vector<glm::ivec3> queries(1u << 20);
+    for (glm::ivec3& query : queries)
+    {
+        // One in four misses, falling just outside the area
+        query = coords[random() % coords.size()];
+        if (random() % 4 == 0)
+            query.y += 8;
+    }
+
+    using Clock = std::chrono::high_resolution_clock;
+    auto measure = [&](const char* name, auto insert, auto find, auto erase)
+    {
+        const auto start = Clock::now();
+        for (uint32_t i = 0; i < coords.size(); i++)
+            insert(coords[i], i);
+        const auto inserted = Clock::now();
+        uint32_t found = 0;
+        for (const glm::ivec3& query : queries)
+            found += find(query) ? 1 : 0;
+        const auto looked = Clock::now();
+        for (const glm::ivec3& coord : coords)
+            erase(coord);
+        const auto erased = Clock::now();
+
+        auto nanoseconds = [](Clock::duration time, size_t count) { return std::chrono::duration<double, std::nano>(time).count() / count; };
+        ET_INFO(name, "insert", nanoseconds(inserted - start, coords.size()), "ns, find", nanoseconds(looked - inserted, queries.size()),
+                "ns, erase", nanoseconds(erased - looked, coords.size()), "ns,", found, "found");
+    };
+
+    ChunkMap<uint32_t> chunkMap;
+    measure("ChunkMap:",
+        [&](const glm::ivec3& coord, uint32_t value) { chunkMap[coord] = value; },
+        [&](const glm::ivec3& coord) { return chunkMap.Find(coord) != nullptr; },
+        [&](const glm::ivec3& coord) { chunkMap.Erase(coord); });
+
+    // Keyed the way code used before ChunkMap did
+    auto key = [](const glm::ivec3& coord)
+    {
+        const uint64_t mask = (1u << 21) - 1;
+        return (static_cast<uint64_t>(coord.x) & mask) | ((static_cast<uint64_t>(coord.y) & mask) << 21) | ((static_cast<uint64_t>(coord.z) & mask) << 42);
+    };
+    std::unordered_map<uint64_t, uint32_t> unorderedMap;
+    measure("std::unordered_map:",
+        [&](const glm::ivec3& coord, uint32_t value) { unorderedMap[key(coord)] = value; },
+        [&](const glm::ivec3& coord) { return unorderedMap.find(key(coord)) != unorderedMap.end(); },
+        [&](const glm::ivec3& coord) { unorderedMap.erase(key(coord)); });
+}
+
+void RunBenchmarks()
+{
+    ET_INFO("Benchmarks: chunk size", chunkSize, mortonLayout ? "Morton" : "linear", "voxel layout");
+    TerrainGenerator().ReportThroughput();
+
+    // 96 x 24 x 96 blocks whatever chunk size is
+    const glm::ivec3 blocks(96, 24, 96);
+    World world((blocks + glm::ivec3(chunkSize - 1)) / chunkSize);
+    for (int x = 0; x < world.GetExtent().x; x++)
+        for (int y = 0; y < world.GetExtent().y; y++)
+            for (int z = 0; z < world.GetExtent().z; z++)
+                world.CreateChunk({ x, y, z });
+
+    using Clock = std::chrono::high_resolution_clock;
+    const auto start = Clock::now();
+    world.RemeshDirty();
+    const double seconds = std::chrono::duration<double, std::chrono::seconds::period>(Clock::now() - start).count();
+    ET_INFO("World first light and mesh of", world.GetChunkCount(), "chunks:", seconds * 1e3, "ms");
+
+    world.ReportMeshStats();
+    world.ReportLightThroughput();
+    world.ReportVisibility();
+    world.ReportRaycastThroughput();
+    Eternity::Frustum::ReportThroughput();
+    ReportChunkMapThroughput();
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+/// Log throughput of terrain generation, meshing, lighting, visibility, raycasts, frustum culling and chunk map.
+/// Every measure is reported per voxel or over a world of same size in blocks, so builds with different
+/// ET_CHUNK_SIZE can be compared
+void RunBenchmarks();
@@ -1,18 +1,63 @@
 #pragma once
 #include <initializer_list>
 #include <vector>
+#include <cstdint>
 #include <glm/glm.hpp>
 
+enum class BlockFace
+{
+    Left,
+    Right,
+    Bottom,
+    Top,
+    Back,
+    Front
+};
+
+inline glm::ivec3 GetFaceNormal(BlockFace face)
+{
+    static const glm::ivec3 normals[] = { { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 } };
+    return normals[static_cast<int>(face)];
+}
+
+inline BlockFace GetOppositeFace(BlockFace face)
+{
+    // Faces are declared in (negative, positive) pairs
+    return static_cast<BlockFace>(static_cast<int>(face) ^ 1);
+}
+
 struct Block
 {
-    enum class Type
+    enum class Type : uint8_t
     {
         Air,
         Ground,
-        TopGround
+        TopGround,
+        Lamp
     };
+    static const uint8_t typeCount = 4;
 
     Type type;
     Block() : type(Type::Air) {}
     Block(Type type) : type(type) {}
-};
\ No newline at end of file
+
+    /// Atlas cell (16x16 grid) used to texture given face of block type
+    static glm::ivec2 GetAtlasTile(Type type, BlockFace face)
+    {
+        if (type == Type::Lamp)
+            return { 9, 6 };
+
+        switch (face)
+        {
+            case BlockFace::Top:    return { 0, 0 };
+            case BlockFace::Bottom: return { 2, 0 };
+            default:                return { 3, 0 };
+        }
+    }
+
+    /// Block light level (0 - 15) given off by block type
+    static uint8_t GetEmission(Type type)
+    {
+        return type == Type::Lamp ? 15 : 0;
+    }
+};
@@ -1,121 +1,116 @@
 #include "Chunk.hpp"
-#include "Block.hpp"
+#include "Base.hpp"
 
-Chunk::Chunk(glm::ivec3 pos)
-    : m_Vertices(vertices), m_Indices(indices), m_Pos(pos)
-{
-    GenerateLandscape();
-	GenerateMesh();
-}
+#include <algorithm>
 
-void Chunk::PushLeft(const glm::vec3& pos)
+/// FNV-1a hash of mesh content, 0 for empty mesh
+static uint64_t HashMesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
 {
-    m_Vertices.push_back({ .pos = glm::vec3(-0.5, -0.5, -0.5)   + m_Pos + pos, .texCoord = glm::vec2(3.0f / 16.0f, 1.0f / 16.0f) });
-    m_Vertices.push_back({ .pos = glm::vec3(-0.5, -0.5, 0.5)    + m_Pos + pos, .texCoord = glm::vec2(4.0f / 16.0f, 1.0f / 16.0f) });
-    m_Vertices.push_back({ .pos = glm::vec3(-0.5, 0.5, -0.5)    + m_Pos + pos, .texCoord = glm::vec2(3.0f / 16.0f, 0.0f) });
-    m_Vertices.push_back({ .pos = glm::vec3(-0.5, 0.5, 0.5)     + m_Pos + pos, .texCoord = glm::vec2(4.0f / 16.0f, 0.0f) });
+    if (indices.empty())
+        return 0;
 
-    PushIndices();
-}
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&](uint32_t value)
+    {
+        for (int byte = 0; byte < 4; byte++, value >>= 8)
+            hash = (hash ^ (value & 0xff)) * 1099511628211ull;
+    };
 
-void Chunk::PushRight(const glm::vec3& pos)
-{
-    m_Vertices.push_back({ .pos = glm::vec3(0.5, -0.5, 0.5)    + m_Pos + pos, .texCoord = glm::vec2(3.0f / 16.0f, 1.0f / 16.0f) });
-    m_Vertices.push_back({ .pos = glm::vec3(0.5, -0.5, -0.5)   + m_Pos + pos, .texCoord = glm::vec2(4.0f / 16.0f, 1.0f / 16.0f) });
-    m_Vertices.push_back({ .pos = glm::vec3(0.5, 0.5, 0.5)     + m_Pos + pos, .texCoord = glm::vec2(3.0f / 16.0f, 0.0f) });
-    m_Vertices.push_back({ .pos = glm::vec3(0.5, 0.5, -0.5)    + m_Pos + pos, .texCoord = glm::vec2(4.0f / 16.0f, 0.0f) });
+    for (const Vertex& vertex : vertices)
+    {
+        add(vertex.data);
+        add(vertex.material);
+    }
+    for (uint32_t index : indices)
+        add(index);
 
-    PushIndices();
+    return hash != 0 ? hash : 1;
 }
 
-void Chunk::PushBottom(const glm::vec3& pos)
+Chunk::Chunk(glm::ivec3 coord, MeshMode mode /* = MeshMode::Greedy */)
+    : m_Coord(coord), m_Pos(coord * chunkSize), m_MeshMode(mode), m_Revision(std::make_shared<std::atomic<uint32_t>>(0))
 {
-    m_Vertices.push_back({ .pos = glm::vec3(0.5, -0.5, -0.5)    + m_Pos + pos, .texCoord = glm::vec2(2.0f / 16.0f, 1.0f / 16.0f) });
-    m_Vertices.push_back({ .pos = glm::vec3(0.5, -0.5, 0.5)     + m_Pos + pos, .texCoord = glm::vec2(3.0f / 16.0f, 1.0f / 16.0f) });
-    m_Vertices.push_back({ .pos = glm::vec3(-0.5, -0.5, -0.5)   + m_Pos + pos, .texCoord = glm::vec2(2.0f / 16.0f, 0.0f) });
-    m_Vertices.push_back({ .pos = glm::vec3(-0.5, -0.5, 0.5)    + m_Pos + pos, .texCoord = glm::vec2(3.0f / 16.0f, 0.0f) });
-
-    PushIndices();
+    // Mesh corner coordinates start at min side of block (0, 0, 0), which is centered at m_Pos
+    origin = m_Pos - glm::vec3(0.5f);
 }
 
-void Chunk::PushTop(const glm::vec3& pos)
+void Chunk::GenerateLandscape(const TerrainGenerator& generator)
 {
-    m_Vertices.push_back({ .pos = glm::vec3(-0.5, 0.5, -0.5)    + m_Pos + pos, .texCoord = glm::vec2(0, 0) });
-    m_Vertices.push_back({ .pos = glm::vec3(-0.5, 0.5, 0.5)     + m_Pos + pos, .texCoord = glm::vec2(0, 1.0f / 16.0f) });
-    m_Vertices.push_back({ .pos = glm::vec3(0.5, 0.5, -0.5)     + m_Pos + pos, .texCoord = glm::vec2(1.0f / 16.0f, 0) });
-    m_Vertices.push_back({ .pos = glm::vec3(0.5, 0.5, 0.5)      + m_Pos + pos, .texCoord = glm::vec2(1.0f / 16.0f, 1.0f / 16.0f) });
-
-    PushIndices();
+    generator.Generate(m_Coord, m_ChunkData);
+    // Generation is deterministic but costs more than reading chunk back
+    m_Unsaved = true;
 }
 
-void Chunk::PushBack(const glm::vec3& pos)
+MeshStats Chunk::GenerateMesh(const ChunkBorders& borders)
 {
-    m_Vertices.push_back({ .pos = glm::vec3(0.5, -0.5, -0.5)    + m_Pos + pos, .texCoord = glm::vec2(3.0f / 16.0f, 1.0f / 16.0f) });
-    m_Vertices.push_back({ .pos = glm::vec3(-0.5, -0.5, -0.5)   + m_Pos + pos, .texCoord = glm::vec2(4.0f / 16.0f, 1.0f / 16.0f) });
-    m_Vertices.push_back({ .pos = glm::vec3(0.5, 0.5, -0.5)     + m_Pos + pos, .texCoord = glm::vec2(3.0f / 16.0f, 0.0f) });
-    m_Vertices.push_back({ .pos = glm::vec3(-0.5, 0.5, -0.5)    + m_Pos + pos, .texCoord = glm::vec2(4.0f / 16.0f, 0.0f) });
-
-    PushIndices();
+    SetSections(Mesher::BuildSections(m_ChunkData, borders, m_MeshMode, m_Lod), FaceConnectivity::Compute(m_ChunkData));
+    return GetMeshStats();
 }
 
-void Chunk::PushFront(const glm::vec3& pos)
+void Chunk::GenerateSections(uint32_t sectionMask, const ChunkBorders& borders)
 {
-    m_Vertices.push_back({ .pos = glm::vec3(-0.5, -0.5, 0.5)    + m_Pos + pos, .texCoord = glm::vec2(3.0f / 16.0f, 1.0f / 16.0f) });
-    m_Vertices.push_back({ .pos = glm::vec3(0.5, -0.5, 0.5)     + m_Pos + pos, .texCoord = glm::vec2(4.0f / 16.0f, 1.0f / 16.0f) });
-    m_Vertices.push_back({ .pos = glm::vec3(-0.5, 0.5, 0.5)     + m_Pos + pos, .texCoord = glm::vec2(3.0f / 16.0f, 0.0f) });
-    m_Vertices.push_back({ .pos = glm::vec3(0.5, 0.5, 0.5)      + m_Pos + pos, .texCoord = glm::vec2(4.0f / 16.0f, 0.0f) });
+    ET_ASSERT(m_Lod == 0);
+    int firstChanged = meshSectionCount;
+    for (int section = 0; section < meshSectionCount; section++)
+    {
+        if ((sectionMask & (1u << section)) == 0)
+            continue;
 
-    PushIndices();
+        m_Sections[section] = Mesher::BuildSection(m_ChunkData, borders, m_MeshMode, section);
+        firstChanged = std::min(firstChanged, section);
+    }
+
+    // Edits may open or close paths through chunk
+    m_Connectivity = FaceConnectivity::Compute(m_ChunkData);
+    JoinSections(firstChanged);
 }
 
-void Chunk::PushIndices()
+void Chunk::SetSections(std::vector<ChunkMesh>&& sections, const FaceConnectivity& connectivity)
 {
-    uint32_t m;
-    if (!m_Indices.empty())
-        m = m_Indices.back() + 1;
-    else
-        m = 0;
-    m_Indices.insert(m_Indices.end(), { 0 + m, 1 + m, 2 + m, 2 + m, 1 + m, 3 + m });
+    m_Connectivity = connectivity;
+    for (int section = 0; section < meshSectionCount; section++)
+        m_Sections[section] = std::move(sections[section]);
+
+    m_HasSections   = true;
+    m_MeshInFlight  = false;
+    JoinSections(0);
 }
 
-void Chunk::GenerateLandscape()
+void Chunk::JoinSections(int firstChanged)
 {
-    for (int z = 0; z < m_Size; z++)
+    size_t vertexOffset = 0;
+    size_t indexOffset  = 0;
+    for (int section = 0; section < firstChanged; section++)
     {
-        for (int y = 0; y < m_Size; y++)
-        {
-            for (int x = 0; x < m_Size; x++)
-            {
-                m_ChunkData.At({x, y, z}).type = Block::Type::TopGround;
-            }
-        }
+        vertexOffset    += m_Sections[section].vertices.size();
+        indexOffset     += m_Sections[section].indices.size();
     }
-}
 
-void Chunk::GenerateMesh()
-{
-    for (int z = 0; z < m_Size; z++)
+    vertices.resize(vertexOffset);
+    indices.resize(indexOffset);
+    for (int section = firstChanged; section < meshSectionCount; section++)
     {
-        for (int y = 0; y < m_Size; y++)
-        {
-            for (int x = 0; x < m_Size; x++)
-            {
-                if (m_ChunkData.At({x, y, z}).type != Block::Type::Air)
-                {
-                    if (m_ChunkData.LeftType({ x, y, z }) == Block::Type::Air)
-                        PushLeft({ x, y, z });
-                    if (m_ChunkData.RightType({ x, y, z }) == Block::Type::Air)
-                        PushRight({ x, y, z });
-                    if (m_ChunkData.BackType({ x, y, z }) == Block::Type::Air)
-                        PushBack({ x, y, z });
-                    if (m_ChunkData.FrontType({ x, y, z }) == Block::Type::Air)
-                        PushFront({x, y, z });
-                    if (m_ChunkData.BottomType({ x, y, z }) == Block::Type::Air)
-                        PushBottom({ x, y, z });
-                    if (m_ChunkData.TopType({ x, y, z }) == Block::Type::Air)
-                        PushTop({ x, y, z });
-                }
-            }
-        }
+        const uint32_t base = static_cast<uint32_t>(vertices.size());
+        vertices.insert(vertices.end(), m_Sections[section].vertices.begin(), m_Sections[section].vertices.end());
+        for (uint32_t index : m_Sections[section].indices)
+            indices.push_back(index + base);
     }
-}
\ No newline at end of file
+
+    // Culling box fits geometry, chunks are mostly empty above and below surface
+    glm::ivec3 min(Vertex::maxCoordinate);
+    glm::ivec3 max(0);
+    for (const Vertex& vertex : vertices)
+    {
+        min = glm::min(min, vertex.GetPosition());
+        max = glm::max(max, vertex.GetPosition());
+    }
+    boundsMin = origin + glm::vec3(min);
+    boundsMax = origin + glm::vec3(max);
+
+    // Chunks of flat or repeating terrain often end up with the same mesh, renderer draws one copy of it
+    meshKey = HashMesh(vertices, indices);
+
+    // Earlier sections keep their place in buffers
+    dirtyVertexOffset   = std::min(dirtyVertexOffset, vertexOffset);
+    dirtyIndexOffset    = std::min(dirtyIndexOffset, indexOffset);
+}
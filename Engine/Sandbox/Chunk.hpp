@@ -1,115 +1,74 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <memory>
 #include <glm/glm.hpp>
 
 #include "../Eternity.hpp"
 #include "Block.hpp"
-
-static const int chunkSize = 6;
-
-class ChunkData
-{
-    private:
-        const int m_Size = chunkSize;
-        std::vector<Block> m_Data;
-    public:
-        ChunkData() : m_Data(chunkSize * chunkSize * chunkSize) {}
-        Block& At(const glm::ivec3& pos)
-        { 
-            return m_Data[((pos.x * m_Size * m_Size) + (pos.y * m_Size) + pos.z)];
-        }
-
-        const Block& At(const glm::ivec3& pos) const
-        {
-            return m_Data.at(((pos.x * m_Size * m_Size) + (pos.y * m_Size) + pos.z));
-        }
-
-        const Block::Type LeftType(const glm::ivec3& pos) const
-        {
-            if (pos.x == 0)
-                return Block::Type::Air;
-            else
-                return At({ pos.x - 1, pos.y, pos.z }).type;
-        };
-
-        const Block::Type RightType(const glm::ivec3& pos) const
-        {
-            if (pos.x == m_Size - 1)
-                return Block::Type::Air;
-            else
-                return At({ pos.x + 1, pos.y, pos.z }).type;
-        }
-
-        const Block::Type BottomType(const glm::ivec3& pos) const
-        {
-            if (pos.y == 0)
-                return Block::Type::Air;
-            else
-                return At({ pos.x, pos.y - 1, pos.z }).type;
-        }
-
-        const Block::Type TopType(const glm::ivec3& pos) const
-        {
-            if (pos.y == m_Size - 1)
-                return Block::Type::Air;
-            else
-                return At({ pos.x, pos.y + 1, pos.z }).type;
-        }
-
-        const Block::Type BackType(const glm::ivec3& pos) const
-        {
-            if (pos.z == 0)
-                return Block::Type::Air;
-            else
-                return At({ pos.x, pos.y, pos.z - 1 }).type;
-        }
-
-        const Block::Type FrontType(const glm::ivec3& pos) const
-        {
-            if (pos.z == m_Size - 1)
-                return Block::Type::Air;
-            else
-                return At({ pos.x, pos.y, pos.z + 1 }).type;
-        }
-};
+#include "ChunkData.hpp"
+#include "FaceConnectivity.hpp"
+#include "Mesher.hpp"
+#include "TerrainGenerator.hpp"
 
 class Chunk : public Eternity::Renderable
 {
     private:
-        glm::vec3               m_Pos;
-        const int               m_Size = chunkSize;
-        ChunkData               m_ChunkData;
-        std::vector<Vertex>&    m_Vertices;
-        std::vector<uint32_t>&  m_Indices;
-
-        // Push face into given pos. (In chunk coordinate system not world global)
-        void PushLeft(const glm::vec3& pos);
-        void PushRight(const glm::vec3& pos);
-        void PushBottom(const glm::vec3& pos);
-        void PushTop(const glm::vec3& pos);
-        void PushBack(const glm::vec3& pos);
-        void PushFront(const glm::vec3& pos);
-
-        /// Add 6 more indices
-        void PushIndices();
-
-        /// Generate landscape and save map setup to chunk data
-        void GenerateLandscape();
-        /// Push all vertices and indices
-        void GenerateMesh();
-
-        bool needUpdate = false;
+        glm::ivec3                              m_Coord;
+        glm::vec3                               m_Pos;
+        ChunkData                               m_ChunkData;
+        MeshMode                                m_MeshMode;
+        int                                     m_Lod           = 0;
+        std::array<ChunkMesh, meshSectionCount> m_Sections;             // vertices and indices are these concatenated
+        bool                                    m_HasSections   = false;
+        bool                                    m_MeshInFlight  = false;  // full mesh job submitted, not applied yet
+        bool                                    m_Unsaved       = false;  // blocks differ from what storage holds
+        bool                                    m_Lit           = false;  // first light pass over chunk is done
+        FaceConnectivity                        m_Connectivity  = FaceConnectivity::Open();  // of blocks last meshed
+        // Bumped on every change that invalidates mesh, shared with in-flight mesh jobs
+        std::shared_ptr<std::atomic<uint32_t>>  m_Revision;
+
+        /// Rebuild vertices and indices from sections, only data from first changed section on is marked dirty
+        void JoinSections(int firstChanged);
     public:
-        Chunk(glm::ivec3 pos);
+        /// Empty chunk at given chunk coordinate, World fills it from storage or generator.
+        /// Mesh is built later by World once neighbors are known
+        Chunk(glm::ivec3 coord, MeshMode mode = MeshMode::Greedy);
 
-        void TestBlockDig()
-        {
-            static int i = 0;
-            m_ChunkData.At({ m_Size / 2 - i, m_Size - 1, m_Size / 2 - i }).type = Block::Type::Air;
-            m_Vertices.clear();
-            m_Indices.clear();
-            GenerateMesh();
-            i--;
-        }
-};
\ No newline at end of file
+        /// Generate landscape and save map setup to chunk data
+        void GenerateLandscape(const TerrainGenerator& generator);
+
+        /// Build mesh on calling thread
+        MeshStats GenerateMesh(const ChunkBorders& borders);
+        /// Rebuild sections set in mask on calling thread, rest of mesh is kept
+        void GenerateSections(uint32_t sectionMask, const ChunkBorders& borders);
+        /// Replace current geometry with sections and face connectivity built elsewhere
+        void SetSections(std::vector<ChunkMesh>&& sections, const FaceConnectivity& connectivity);
+        MeshStats GetMeshStats() const { return { vertices.size(), indices.size() }; }
+
+        uint32_t BumpRevision() { return m_Revision->fetch_add(1) + 1; }
+        uint32_t GetRevision() const { return m_Revision->load(); }
+        const std::shared_ptr<std::atomic<uint32_t>>& GetRevisionCounter() const { return m_Revision; }
+
+        /// Sections can be patched only while they describe current data at full detail and no full rebuild is on its way
+        bool CanPatchSections() const { return m_HasSections && !m_MeshInFlight && m_Lod == 0; }
+        void SetMeshInFlight(bool inFlight) { m_MeshInFlight = inFlight; }
+
+        /// Chunk isn't meshed before its light is known
+        bool IsLit() const { return m_Lit; }
+        void SetLit(bool lit) { m_Lit = lit; }
+
+        bool IsUnsaved() const { return m_Unsaved; }
+        void SetUnsaved(bool unsaved) { m_Unsaved = unsaved; }
+
+        /// Level of detail used by next mesh build
+        void SetLod(int lod) { m_Lod = lod; }
+        int                 GetLod() const { return m_Lod; }
+        MeshMode            GetMeshMode() const { return m_MeshMode; }
+        const FaceConnectivity& GetConnectivity() const { return m_Connectivity; }
+        const glm::ivec3&   GetCoord() const { return m_Coord; }
+        const glm::vec3&    GetPos() const { return m_Pos; }
+        ChunkData&          GetData() { return m_ChunkData; }
+        const ChunkData&    GetData() const { return m_ChunkData; }
+};
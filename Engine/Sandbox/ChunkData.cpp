@@ -0,0 +1,393 @@
+#include "ChunkData.hpp"
+
+#include <algorithm>
+
+ChunkData::ChunkData(Block::Type type /* = Block::Type::Air */)
+{
+    Fill(type);
+}
+
+void ChunkData::Fill(Block::Type type)
+{
+    m_Palette       = { type };
+    m_PaletteRefs   = { chunkVolume };
+    m_Bits          = 0;
+    m_Indices.clear();
+    m_Indices.shrink_to_fit();
+}
+
+void ChunkData::Assign(const std::vector<Block::Type>& blocks)
+{
+    std::vector<Block::Type> palette;
+    std::vector<uint32_t> refs;
+    std::vector<uint32_t> indices(chunkVolume);
+
+    for (uint32_t i = 0; i < chunkVolume; i++)
+    {
+        const auto entry = std::find(palette.begin(), palette.end(), blocks[i]);
+        indices[i] = static_cast<uint32_t>(entry - palette.begin());
+        if (entry == palette.end())
+        {
+            palette.push_back(blocks[i]);
+            refs.push_back(0);
+        }
+        refs[indices[i]]++;
+    }
+
+    if (palette.size() == 1)
+    {
+        Fill(palette[0]);
+        return;
+    }
+
+    uint32_t bits = 1;
+    while ((1u << bits) < palette.size())
+        bits <<= 1;
+
+    m_Palette       = std::move(palette);
+    m_PaletteRefs   = std::move(refs);
+    m_Bits          = bits;
+    m_Indices.assign((chunkVolume * m_Bits + 63) / 64, 0);
+    m_Indices.shrink_to_fit();
+
+    for (uint32_t voxel = 0; voxel < chunkVolume; voxel++)
+        SetPaletteIndex(voxel, indices[voxel]);
+}
+
+std::vector<uint8_t> ChunkData::Encode() const
+{
+    std::vector<uint8_t> encoded;
+
+    auto pushRun = [&](uint32_t length, Block::Type type)
+    {
+        for (; length >= 0x80; length >>= 7)
+            encoded.push_back(static_cast<uint8_t>(length | 0x80));
+        encoded.push_back(static_cast<uint8_t>(length));
+        encoded.push_back(static_cast<uint8_t>(type));
+    };
+
+    if (m_Bits == 0)
+    {
+        pushRun(chunkVolume, m_Palette[0]);
+        return encoded;
+    }
+
+    Block::Type runType = At({ 0, 0, 0 }).type;
+    uint32_t runLength = 0;
+    for (int x = 0; x < chunkSize; x++)
+    {
+        for (int y = 0; y < chunkSize; y++)
+        {
+            for (int z = 0; z < chunkSize; z++)
+            {
+                const Block::Type type = At({ x, y, z }).type;
+                if (type != runType)
+                {
+                    pushRun(runLength, runType);
+                    runType     = type;
+                    runLength   = 0;
+                }
+                runLength++;
+            }
+        }
+    }
+    pushRun(runLength, runType);
+
+    return encoded;
+}
+
+bool ChunkData::Decode(const uint8_t* data, size_t size)
+{
+    std::vector<Block::Type> blocks;
+    blocks.reserve(chunkVolume);
+
+    size_t i = 0;
+    while (i < size)
+    {
+        uint32_t length = 0;
+        for (int shift = 0; ; shift += 7)
+        {
+            if (i >= size || shift > 28)
+                return false;
+            const uint8_t byte = data[i++];
+            length |= static_cast<uint32_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+                break;
+        }
+
+        if (i >= size || data[i] >= Block::typeCount || length > chunkVolume - blocks.size())
+            return false;
+        blocks.insert(blocks.end(), length, static_cast<Block::Type>(data[i++]));
+    }
+
+    if (blocks.size() != chunkVolume)
+        return false;
+
+    if constexpr (mortonLayout)
+    {
+        // Runs follow linear order, blocks go to Assign in voxel layout order
+        std::vector<Block::Type> ordered(chunkVolume);
+        uint32_t i = 0;
+        for (int x = 0; x < chunkSize; x++)
+            for (int y = 0; y < chunkSize; y++)
+                for (int z = 0; z < chunkSize; z++)
+                    ordered[VoxelIndex({ x, y, z })] = blocks[i++];
+        blocks = std::move(ordered);
+    }
+
+    Assign(blocks);
+    return true;
+}
+
+void ChunkData::Set(const glm::ivec3& pos, Block::Type type)
+{
+    const uint32_t voxel    = VoxelIndex(pos);
+    const uint32_t oldIndex = GetPaletteIndex(voxel);
+
+    if (m_Palette[oldIndex] == type)
+        return;
+
+    const uint32_t newIndex = AddPaletteEntry(type);
+    // Palette growth may have repacked indices, old entry index is still valid
+    SetPaletteIndex(voxel, newIndex);
+
+    m_PaletteRefs[oldIndex]--;
+    m_PaletteRefs[newIndex]++;
+
+    if (m_PaletteRefs[newIndex] == chunkVolume)
+        Fill(type);
+}
+
+void ChunkData::Compact()
+{
+    if (m_Bits == 0)
+        return;
+
+    std::vector<uint32_t> remap(m_Palette.size());
+    std::vector<Block::Type> palette;
+    std::vector<uint32_t> refs;
+
+    for (uint32_t i = 0; i < m_Palette.size(); i++)
+    {
+        if (m_PaletteRefs[i] == 0)
+            continue;
+        remap[i] = static_cast<uint32_t>(palette.size());
+        palette.push_back(m_Palette[i]);
+        refs.push_back(m_PaletteRefs[i]);
+    }
+
+    if (palette.size() == 1)
+    {
+        Fill(palette[0]);
+        return;
+    }
+
+    uint32_t bits = 1;
+    while ((1u << bits) < palette.size())
+        bits <<= 1;
+
+    std::vector<uint32_t> indices(chunkVolume);
+    for (uint32_t voxel = 0; voxel < chunkVolume; voxel++)
+        indices[voxel] = remap[GetPaletteIndex(voxel)];
+
+    m_Palette       = std::move(palette);
+    m_PaletteRefs   = std::move(refs);
+    m_Bits          = bits;
+    m_Indices.assign((chunkVolume * m_Bits + 63) / 64, 0);
+    m_Indices.shrink_to_fit();
+
+    for (uint32_t voxel = 0; voxel < chunkVolume; voxel++)
+        SetPaletteIndex(voxel, indices[voxel]);
+}
+
+ChunkData ChunkData::Downsample(int scale) const
+{
+    if (scale <= 1)
+        return *this;
+    if (m_Bits == 0)
+    {
+        ChunkData coarse(m_Palette[0]);
+        coarse.FillLight(PackLight(maxLightLevel, 0));
+        return coarse;
+    }
+
+    std::vector<Block::Type> blocks(chunkVolume);
+    for (int cx = 0; cx < chunkSize; cx += scale)
+    {
+        for (int cy = 0; cy < chunkSize; cy += scale)
+        {
+            for (int cz = 0; cz < chunkSize; cz += scale)
+            {
+                const glm::ivec3 min(cx, cy, cz);
+                const glm::ivec3 max = glm::min(min + scale, glm::ivec3(chunkSize));
+
+                int solid = 0;
+                int topY = -1;
+                Block::Type top = Block::Type::Air;
+                for (int x = min.x; x < max.x; x++)
+                    for (int y = min.y; y < max.y; y++)
+                        for (int z = min.z; z < max.z; z++)
+                        {
+                            const Block::Type type = At({ x, y, z }).type;
+                            if (type == Block::Type::Air)
+                                continue;
+                            solid++;
+                            if (y > topY)
+                            {
+                                topY = y;
+                                top = type;
+                            }
+                        }
+
+                const glm::ivec3 size = max - min;
+                const Block::Type fill = solid * 2 >= size.x * size.y * size.z ? top : Block::Type::Air;
+                for (int x = min.x; x < max.x; x++)
+                    for (int y = min.y; y < max.y; y++)
+                        for (int z = min.z; z < max.z; z++)
+                            blocks[VoxelIndex({ x, y, z })] = fill;
+            }
+        }
+    }
+
+    // Distant chunks are drawn in full daylight, their light isn't worth tracking
+    ChunkData coarse;
+    coarse.Assign(blocks);
+    coarse.FillLight(PackLight(maxLightLevel, 0));
+    return coarse;
+}
+
+void ChunkData::SetLight(std::vector<uint8_t>&& light)
+{
+    if (std::all_of(light.begin(), light.end(), [&](uint8_t value) { return value == light[0]; }))
+    {
+        FillLight(light[0]);
+        return;
+    }
+
+    m_Light = std::move(light);
+}
+
+void ChunkData::FillLight(uint8_t light)
+{
+    m_UniformLight = light;
+    m_Light.clear();
+    m_Light.shrink_to_fit();
+}
+
+std::vector<uint8_t> ChunkData::CopyLight() const
+{
+    if (m_Light.empty())
+        return std::vector<uint8_t>(chunkVolume, m_UniformLight);
+    return m_Light;
+}
+
+std::vector<uint8_t> ChunkData::GetBorderLight(BlockFace face) const
+{
+    const glm::ivec3 normal = GetFaceNormal(face);
+    const int axis  = normal.x != 0 ? 0 : (normal.y != 0 ? 1 : 2);
+    const int depth = (normal[axis] < 0) ? 0 : chunkSize - 1;
+
+    std::vector<uint8_t> layer(chunkSize * chunkSize, m_UniformLight);
+    if (m_Light.empty())
+        return layer;
+
+    for (int a = 0; a < chunkSize; a++)
+    {
+        for (int b = 0; b < chunkSize; b++)
+        {
+            glm::ivec3 pos;
+            pos[axis]           = depth;
+            pos[(axis + 1) % 3] = a;
+            pos[(axis + 2) % 3] = b;
+            layer[BorderIndex(face, pos)] = m_Light[VoxelIndex(pos)];
+        }
+    }
+
+    return layer;
+}
+
+size_t ChunkData::GetMemoryUsage() const
+{
+    return sizeof(ChunkData) 
+        + m_Palette.capacity() * sizeof(Block::Type)
+        + m_PaletteRefs.capacity() * sizeof(uint32_t)
+        + m_Indices.capacity() * sizeof(uint64_t)
+        + m_Light.capacity();
+}
+
+std::vector<Block::Type> ChunkData::GetBorderLayer(BlockFace face) const
+{
+    const glm::ivec3 normal = GetFaceNormal(face);
+    const int axis  = normal.x != 0 ? 0 : (normal.y != 0 ? 1 : 2);
+    const int depth = (normal[axis] < 0) ? 0 : chunkSize - 1;
+
+    std::vector<Block::Type> layer(chunkSize * chunkSize, m_Palette[0]);
+    if (m_Bits == 0)
+        return layer;
+
+    for (int a = 0; a < chunkSize; a++)
+    {
+        for (int b = 0; b < chunkSize; b++)
+        {
+            glm::ivec3 pos;
+            pos[axis]           = depth;
+            pos[(axis + 1) % 3] = a;
+            pos[(axis + 2) % 3] = b;
+            layer[BorderIndex(face, pos)] = At(pos).type;
+        }
+    }
+
+    return layer;
+}
+
+void ChunkData::SetPaletteIndex(uint32_t voxel, uint32_t index)
+{
+    const uint32_t bit  = voxel * m_Bits;
+    const uint64_t mask = ((1ull << m_Bits) - 1) << (bit & 63);
+    uint64_t& word = m_Indices[bit >> 6];
+    word = (word & ~mask) | (static_cast<uint64_t>(index) << (bit & 63));
+}
+
+uint32_t ChunkData::AddPaletteEntry(Block::Type type)
+{
+    for (uint32_t i = 0; i < m_Palette.size(); i++)
+    {
+        if (m_Palette[i] == type)
+            return i;
+    }
+
+    // Reuse entry no voxel points to anymore
+    for (uint32_t i = 0; i < m_Palette.size(); i++)
+    {
+        if (m_PaletteRefs[i] == 0)
+        {
+            m_Palette[i] = type;
+            return i;
+        }
+    }
+
+    m_Palette.push_back(type);
+    m_PaletteRefs.push_back(0);
+
+    if (m_Palette.size() > (1u << m_Bits))
+        Repack(m_Bits == 0 ? 1 : m_Bits << 1);
+
+    return static_cast<uint32_t>(m_Palette.size() - 1);
+}
+
+void ChunkData::Repack(uint32_t bits)
+{
+    std::vector<uint64_t> indices((chunkVolume * bits + 63) / 64, 0);
+
+    if (m_Bits != 0)
+    {
+        for (uint32_t voxel = 0; voxel < chunkVolume; voxel++)
+        {
+            const uint32_t bit = voxel * bits;
+            indices[bit >> 6] |= static_cast<uint64_t>(GetPaletteIndex(voxel)) << (bit & 63);
+        }
+    }
+
+    m_Indices   = std::move(indices);
+    m_Bits      = bits;
+}
@@ -0,0 +1,310 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Block.hpp"
+
+#ifndef ET_CHUNK_SIZE
+    #define ET_CHUNK_SIZE 6
+#endif
+
+/// Blocks along each chunk edge, chosen at configure time (ET_CHUNK_SIZE). Voxel index math of power of two
+/// sizes compiles to shifts and masks
+static constexpr int        chunkSize   = ET_CHUNK_SIZE;
+static constexpr uint32_t   chunkVolume = chunkSize * chunkSize * chunkSize;
+static_assert(chunkSize >= 2, "Chunk must be at least 2 blocks wide");
+
+static constexpr bool IsPowerOfTwo(int value) { return value > 0 && (value & (value - 1)) == 0; }
+static constexpr int Log2(int value) { return value > 1 ? 1 + Log2(value / 2) : 0; }
+
+/// Chunk coordinate of block coordinate along one axis, rounded toward negative infinity
+inline int BlockToChunk(int value)
+{
+    if constexpr (IsPowerOfTwo(chunkSize))
+        return value >> Log2(chunkSize);
+    else
+        return (value >= 0) ? value / chunkSize : -((-value + chunkSize - 1) / chunkSize);
+}
+
+/// Block coordinate inside its chunk along one axis
+inline int BlockToLocal(int value)
+{
+    if constexpr (IsPowerOfTwo(chunkSize))
+        return value & (chunkSize - 1);
+    else
+        return value - BlockToChunk(value) * chunkSize;
+}
+
+#ifndef ET_MORTON_LAYOUT
+    #define ET_MORTON_LAYOUT 0
+#endif
+
+/// Order of voxels in dense per-voxel arrays of a chunk (blocks, light), chosen at configure time (ET_MORTON_LAYOUT).
+/// Linear order runs by x, then y, then z (z varies fastest), so neighbors along x lie a whole layer apart.
+/// Morton order interleaves bits of x, y and z, keeping small cubes of voxels together. It needs power of two chunk size
+static constexpr bool mortonLayout = ET_MORTON_LAYOUT != 0;
+static_assert(!mortonLayout || IsPowerOfTwo(chunkSize), "Morton voxel layout needs power of two chunk size");
+
+/// Index steps of linear order along x, y and z
+static constexpr uint32_t voxelStrides[3] = { chunkSize * chunkSize, chunkSize, 1 };
+
+/// Low 10 bits of value spread apart so two zero bits follow each of them
+inline uint32_t SpreadBits(uint32_t value)
+{
+    value &= 0x000003ff;
+    value = (value ^ (value << 16)) & 0xff0000ff;
+    value = (value ^ (value << 8))  & 0x0300f00f;
+    value = (value ^ (value << 4))  & 0x030c30c3;
+    value = (value ^ (value << 2))  & 0x09249249;
+    return value;
+}
+
+/// Inverse of SpreadBits, gathers every third bit
+inline uint32_t CompactBits(uint32_t value)
+{
+    value &= 0x09249249;
+    value = (value ^ (value >> 2))  & 0x030c30c3;
+    value = (value ^ (value >> 4))  & 0x0300f00f;
+    value = (value ^ (value >> 8))  & 0xff0000ff;
+    value = (value ^ (value >> 16)) & 0x000003ff;
+    return value;
+}
+
+/// Morton index bits holding coordinate along axis (0 - x, 1 - y, 2 - z), x takes the highest bit of each triple
+inline uint32_t MortonAxisMask(int axis) { return (0x09249249u << (2 - axis)) & (chunkVolume - 1); }
+
+/// Index of voxel at local position in per-voxel arrays
+inline uint32_t VoxelIndex(const glm::ivec3& pos)
+{
+    if constexpr (mortonLayout)
+        return (SpreadBits(pos.x) << 2) | (SpreadBits(pos.y) << 1) | SpreadBits(pos.z);
+    else
+        return (pos.x * chunkSize + pos.y) * chunkSize + pos.z;
+}
+
+/// Local coordinate of voxel along axis (0 - x, 1 - y, 2 - z)
+inline int VoxelCoord(uint32_t index, int axis)
+{
+    if constexpr (mortonLayout)
+        return static_cast<int>(CompactBits(index >> (2 - axis)));
+    else
+        return static_cast<int>(index / voxelStrides[axis] % chunkSize);
+}
+
+inline glm::ivec3 VoxelPosition(uint32_t index)
+{
+    return { VoxelCoord(index, 0), VoxelCoord(index, 1), VoxelCoord(index, 2) };
+}
+
+/// Index of voxel next to given one across face, voxel must not lie on that face of chunk
+inline uint32_t VoxelStep(uint32_t index, BlockFace face)
+{
+    // Faces come in (negative, positive) pairs per axis
+    const int axis      = static_cast<int>(face) >> 1;
+    const bool positive = (static_cast<int>(face) & 1) != 0;
+    if constexpr (mortonLayout)
+    {
+        // Count up or down only in bits of that axis, carries pass through bits of the other axes
+        const uint32_t mask  = MortonAxisMask(axis);
+        const uint32_t moved = positive ? (index | ~mask) + 1 : (index & mask) - 1;
+        return (moved & mask) | (index & ~mask);
+    }
+    else
+        return positive ? index + voxelStrides[axis] : index - voxelStrides[axis];
+}
+
+/// Index of voxel with coordinate along axis replaced, other coordinates kept
+inline uint32_t VoxelWithCoord(uint32_t index, int axis, int coord)
+{
+    if constexpr (mortonLayout)
+        return (index & ~MortonAxisMask(axis)) | (SpreadBits(static_cast<uint32_t>(coord)) << (2 - axis));
+    else
+        return index + static_cast<uint32_t>(coord - VoxelCoord(index, axis)) * voxelStrides[axis];
+}
+
+/// Voxel light holds sky light in low nibble and block light in high nibble, 0 - 15 each
+static const uint8_t maxLightLevel = 15;
+
+inline uint8_t PackLight(uint8_t sky, uint8_t block) { return static_cast<uint8_t>(sky | (block << 4)); }
+inline uint8_t GetSkyLight(uint8_t light) { return light & 15; }
+inline uint8_t GetBlockLight(uint8_t light) { return light >> 4; }
+
+/// Block layers of neighbor chunks touching each face, indexed by BlockFace.
+/// Empty layer means neighbor isn't loaded and is treated as Air, empty light layer as full sky light.
+struct ChunkBorders
+{
+    std::array<std::vector<Block::Type>, 6> layers;
+    std::array<std::vector<uint8_t>, 6>     light;
+};
+
+/// Block storage of one chunk. Voxels hold indices into a per-chunk palette,
+/// bit-packed with 1/2/4/8 bits per voxel. A chunk made of single block type keeps no index data at all.
+/// Light is kept per voxel next to blocks, collapsed to a single value while it's the same everywhere
+class ChunkData
+{
+    private:
+        std::vector<Block::Type>    m_Palette;
+        std::vector<uint32_t>       m_PaletteRefs;  // voxels referencing each palette entry
+        std::vector<uint64_t>       m_Indices;      // packed palette indices, empty when uniform
+        uint32_t                    m_Bits = 0;     // bits per voxel, 0 when uniform
+        std::vector<uint8_t>        m_Light;        // packed light per voxel, empty when uniform
+        uint8_t                     m_UniformLight = 0;
+
+        uint32_t GetPaletteIndex(uint32_t voxel) const
+        {
+            if (m_Bits == 0)
+                return 0;
+            // Widths are powers of two so entry never straddles two words
+            const uint32_t bit = voxel * m_Bits;
+            return static_cast<uint32_t>(m_Indices[bit >> 6] >> (bit & 63)) & ((1u << m_Bits) - 1);
+        }
+
+        /// Position of voxel inside border layer of given face
+        int BorderIndex(BlockFace face, const glm::ivec3& pos) const
+        {
+            switch (face)
+            {
+                case BlockFace::Left:
+                case BlockFace::Right:  return pos.y * chunkSize + pos.z;
+                case BlockFace::Bottom:
+                case BlockFace::Top:    return pos.x * chunkSize + pos.z;
+                default:                return pos.x * chunkSize + pos.y;
+            }
+        }
+
+        void        SetPaletteIndex(uint32_t voxel, uint32_t index);
+        uint32_t    AddPaletteEntry(Block::Type type);
+        void        Repack(uint32_t bits);
+    public:
+        ChunkData(Block::Type type = Block::Type::Air);
+
+        Block At(const glm::ivec3& pos) const
+        {
+            return Block(m_Palette[GetPaletteIndex(VoxelIndex(pos))]);
+        }
+
+        void Set(const glm::ivec3& pos, Block::Type type);
+        /// Collapse whole chunk to single block type
+        void Fill(Block::Type type);
+        /// Replace every block at once, blocks are ordered by VoxelIndex
+        void Assign(const std::vector<Block::Type>& blocks);
+        /// Drop unreferenced palette entries and shrink index width
+        void Compact();
+        /// Coarse copy made of scale^3 cells (clipped at chunk edge) of one block type each.
+        /// Cell is solid if at least half of it is, and takes type of its highest solid block so surfaces keep their look.
+        /// Coarse copy is lit by full sky light
+        ChunkData Downsample(int scale) const;
+
+        /// Run-length encoded blocks ordered by x, then y, then z whatever the voxel layout is,
+        /// so saved chunks load under either layout: (varint run length, block type) pairs
+        std::vector<uint8_t> Encode() const;
+        /// Replace blocks with encoded ones, returns false and keeps current blocks if data is malformed
+        bool Decode(const uint8_t* data, size_t size);
+
+        uint8_t GetLight(const glm::ivec3& pos) const
+        {
+            return m_Light.empty() ? m_UniformLight : m_Light[VoxelIndex(pos)];
+        }
+
+        /// Replace light of every voxel, ordered by VoxelIndex
+        void SetLight(std::vector<uint8_t>&& light);
+        void FillLight(uint8_t light);
+        /// Light of every voxel ordered by VoxelIndex
+        std::vector<uint8_t> CopyLight() const;
+        /// Copy of light of outermost voxel layer on given face, laid out like GetBorderLayer
+        std::vector<uint8_t> GetBorderLight(BlockFace face) const;
+
+        bool        IsUniform() const { return m_Bits == 0; }
+        bool        IsEmpty() const { return m_Bits == 0 && m_Palette[0] == Block::Type::Air; }
+        uint32_t    GetBitsPerBlock() const { return m_Bits; }
+        size_t      GetMemoryUsage() const;
+
+        /// Copy of outermost block layer on given face, as seen by neighbor chunk through opposite face
+        std::vector<Block::Type> GetBorderLayer(BlockFace face) const;
+
+        const Block::Type LeftType(const glm::ivec3& pos) const
+        {
+            if (pos.x == 0)
+                return Block::Type::Air;
+            else
+                return At({ pos.x - 1, pos.y, pos.z }).type;
+        };
+
+        const Block::Type RightType(const glm::ivec3& pos) const
+        {
+            if (pos.x == chunkSize - 1)
+                return Block::Type::Air;
+            else
+                return At({ pos.x + 1, pos.y, pos.z }).type;
+        }
+
+        const Block::Type BottomType(const glm::ivec3& pos) const
+        {
+            if (pos.y == 0)
+                return Block::Type::Air;
+            else
+                return At({ pos.x, pos.y - 1, pos.z }).type;
+        }
+
+        const Block::Type TopType(const glm::ivec3& pos) const
+        {
+            if (pos.y == chunkSize - 1)
+                return Block::Type::Air;
+            else
+                return At({ pos.x, pos.y + 1, pos.z }).type;
+        }
+
+        const Block::Type BackType(const glm::ivec3& pos) const
+        {
+            if (pos.z == 0)
+                return Block::Type::Air;
+            else
+                return At({ pos.x, pos.y, pos.z - 1 }).type;
+        }
+
+        const Block::Type FrontType(const glm::ivec3& pos) const
+        {
+            if (pos.z == chunkSize - 1)
+                return Block::Type::Air;
+            else
+                return At({ pos.x, pos.y, pos.z + 1 }).type;
+        }
+
+        const Block::Type NeighborType(const glm::ivec3& pos, BlockFace face) const
+        {
+            switch (face)
+            {
+                case BlockFace::Left:   return LeftType(pos);
+                case BlockFace::Right:  return RightType(pos);
+                case BlockFace::Bottom: return BottomType(pos);
+                case BlockFace::Top:    return TopType(pos);
+                case BlockFace::Back:   return BackType(pos);
+                default:                return FrontType(pos);
+            }
+        }
+
+        /// Same as NeighborType but looks into neighbor chunks at the chunk border
+        const Block::Type NeighborType(const glm::ivec3& pos, BlockFace face, const ChunkBorders& borders) const
+        {
+            const glm::ivec3 neighbor = pos + GetFaceNormal(face);
+            if (neighbor.x >= 0 && neighbor.y >= 0 && neighbor.z >= 0 && neighbor.x < chunkSize && neighbor.y < chunkSize && neighbor.z < chunkSize)
+                return At(neighbor).type;
+
+            const std::vector<Block::Type>& layer = borders.layers[static_cast<int>(face)];
+            return layer.empty() ? Block::Type::Air : layer[BorderIndex(face, pos)];
+        }
+
+        /// Light of voxel next to pos, looking into neighbor chunks at the chunk border
+        uint8_t NeighborLight(const glm::ivec3& pos, BlockFace face, const ChunkBorders& borders) const
+        {
+            const glm::ivec3 neighbor = pos + GetFaceNormal(face);
+            if (neighbor.x >= 0 && neighbor.y >= 0 && neighbor.z >= 0 && neighbor.x < chunkSize && neighbor.y < chunkSize && neighbor.z < chunkSize)
+                return GetLight(neighbor);
+
+            const std::vector<uint8_t>& layer = borders.light[static_cast<int>(face)];
+            return layer.empty() ? PackLight(maxLightLevel, 0) : layer[BorderIndex(face, pos)];
+        }
+};
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+/// Flat open addressing hash map from chunk coordinate to T, for lookups of chunks that don't live in World slots.
+/// Coordinates are packed into one 64-bit key (21 bits per axis), mixed by a 64-bit finalizer and probed linearly
+/// in a power of two table. Erase shifts following entries back instead of leaving tombstones, so probe runs stay
+/// short however many entries come and go. Last found slot is checked first, repeated lookups of one chunk are cheap
+template<typename T>
+class ChunkMap
+{
+    private:
+        // Packed keys use 63 bits, so this is never a real key
+        static constexpr uint64_t emptyKey = ~0ull;
+
+        std::vector<uint64_t>   m_Keys;         // probed apart from values, so a probe touches fewer cache lines
+        std::vector<T>          m_Values;
+        size_t                  m_Count = 0;
+        mutable size_t          m_LastSlot = 0; // may be stale, its key is compared before use
+
+        static uint64_t Pack(const glm::ivec3& coord)
+        {
+            const uint64_t mask = (1u << 21) - 1;
+            return (static_cast<uint64_t>(coord.x) & mask) | ((static_cast<uint64_t>(coord.y) & mask) << 21) | ((static_cast<uint64_t>(coord.z) & mask) << 42);
+        }
+
+        static glm::ivec3 Unpack(uint64_t key)
+        {
+            // Shift field to top bits and back to sign extend it
+            auto field = [&](int shift) { return static_cast<int>(static_cast<int64_t>(key << (43 - shift)) >> 43); };
+            return { field(0), field(21), field(42) };
+        }
+
+        /// MurmurHash3 finalizer, every key bit affects every slot bit
+        static uint64_t Hash(uint64_t key)
+        {
+            key ^= key >> 33;
+            key *= 0xff51afd7ed558ccdull;
+            key ^= key >> 33;
+            key *= 0xc4ceb9fe1a85ec53ull;
+            key ^= key >> 33;
+            return key;
+        }
+
+        size_t GetMask() const { return m_Keys.size() - 1; }
+
+        /// Slot holding key, or empty slot where it would go
+        size_t FindSlot(uint64_t key) const
+        {
+            if (m_Keys[m_LastSlot] == key)
+                return m_LastSlot;
+
+            size_t slot = Hash(key) & GetMask();
+            while (m_Keys[slot] != key && m_Keys[slot] != emptyKey)
+                slot = (slot + 1) & GetMask();
+
+            if (m_Keys[slot] == key)
+                m_LastSlot = slot;
+            return slot;
+        }
+
+        void Rehash(size_t capacity)
+        {
+            std::vector<uint64_t> keys(capacity, emptyKey);
+            std::vector<T> values(capacity);
+            m_Keys.swap(keys);
+            m_Values.swap(values);
+            m_LastSlot = 0;
+
+            for (size_t i = 0; i < keys.size(); i++)
+            {
+                if (keys[i] == emptyKey)
+                    continue;
+                const size_t slot = FindSlot(keys[i]);
+                m_Keys[slot]    = keys[i];
+                m_Values[slot]  = std::move(values[i]);
+            }
+        }
+    public:
+        ChunkMap(size_t capacity = 16)
+        {
+            size_t size = 16;
+            while (size < capacity * 2)
+                size <<= 1;
+            m_Keys.assign(size, emptyKey);
+            m_Values.resize(size);
+        }
+
+        T* Find(const glm::ivec3& coord)
+        {
+            const size_t slot = FindSlot(Pack(coord));
+            return m_Keys[slot] != emptyKey ? &m_Values[slot] : nullptr;
+        }
+
+        const T* Find(const glm::ivec3& coord) const
+        {
+            const size_t slot = FindSlot(Pack(coord));
+            return m_Keys[slot] != emptyKey ? &m_Values[slot] : nullptr;
+        }
+
+        /// Value of coordinate, default constructed one is inserted if there's none
+        T& operator[](const glm::ivec3& coord)
+        {
+            const uint64_t key = Pack(coord);
+            size_t slot = FindSlot(key);
+            if (m_Keys[slot] == key)
+                return m_Values[slot];
+
+            // Table stays at most half full
+            if ((m_Count + 1) * 2 > m_Keys.size())
+            {
+                Rehash(m_Keys.size() * 2);
+                slot = FindSlot(key);
+            }
+
+            m_Keys[slot] = key;
+            m_Count++;
+            m_LastSlot = slot;
+            return m_Values[slot];
+        }
+
+        /// Returns false if coordinate had no value
+        bool Erase(const glm::ivec3& coord)
+        {
+            size_t hole = FindSlot(Pack(coord));
+            if (m_Keys[hole] == emptyKey)
+                return false;
+
+            // Pull back entries of the probe run that may live in the hole without moving in front of their home slot
+            for (size_t slot = (hole + 1) & GetMask(); m_Keys[slot] != emptyKey; slot = (slot + 1) & GetMask())
+            {
+                const size_t home = Hash(m_Keys[slot]) & GetMask();
+                if (((slot - home) & GetMask()) < ((slot - hole) & GetMask()))
+                    continue;
+
+                m_Keys[hole]    = m_Keys[slot];
+                m_Values[hole]  = std::move(m_Values[slot]);
+                hole = slot;
+            }
+
+            m_Keys[hole]    = emptyKey;
+            m_Values[hole]  = T();
+            m_Count--;
+            return true;
+        }
+
+        void Clear()
+        {
+            std::fill(m_Keys.begin(), m_Keys.end(), emptyKey);
+            for (T& value : m_Values)
+                value = T();
+            m_Count = 0;
+        }
+
+        /// Call f(const glm::ivec3&, T&) for every entry, in no particular order
+        template<typename F>
+        void ForEach(F&& f)
+        {
+            for (size_t slot = 0; slot < m_Keys.size(); slot++)
+                if (m_Keys[slot] != emptyKey)
+                    f(Unpack(m_Keys[slot]), m_Values[slot]);
+        }
+
+        size_t Size() const { return m_Count; }
+};
@@ -0,0 +1,116 @@
+#include "ChunkStreamer.hpp"
+#include "Base.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+glm::ivec3 StreamingSettings::GetWorldExtent() const
+{
+    // Unload radius is radius + 1, chunks within it on opposite sides must not share a slot
+    const int width = 2 * (radius + 1) + 1;
+    return { width, maxY - minY + 1, width };
+}
+
+ChunkStreamer::ChunkStreamer(World& world, const StreamingSettings& settings)
+    : m_World(world), m_Settings(settings)
+{
+    const glm::ivec3 required = settings.GetWorldExtent();
+    const glm::ivec3& extent = world.GetExtent();
+    ET_ASSERT(extent.x >= required.x && extent.y >= required.y && extent.z >= required.z);
+}
+
+bool ChunkStreamer::InLoadRadius(const glm::ivec3& coord) const
+{
+    const glm::ivec2 offset = glm::ivec2(coord.x, coord.z) - m_Center;
+    return offset.x * offset.x + offset.y * offset.y <= m_Settings.radius * m_Settings.radius;
+}
+
+bool ChunkStreamer::InUnloadRadius(const glm::ivec3& coord) const
+{
+    const int radius = m_Settings.radius + 1;
+    const glm::ivec2 offset = glm::ivec2(coord.x, coord.z) - m_Center;
+    return offset.x * offset.x + offset.y * offset.y <= radius * radius;
+}
+
+int ChunkStreamer::GetLod(const glm::ivec3& coord) const
+{
+    const glm::ivec2 offset = glm::ivec2(coord.x, coord.z) - m_Center;
+    const float distance = std::sqrt(static_cast<float>(offset.x * offset.x + offset.y * offset.y));
+    return std::min(static_cast<int>(distance) / m_Settings.lodDistance, lodCount - 1);
+}
+
+void ChunkStreamer::Recenter(const glm::ivec2& center)
+{
+    m_Center    = center;
+    m_HasCenter = true;
+
+    m_LoadQueue.clear();
+    const int radius = m_Settings.radius;
+    for (int x = -radius; x <= radius; x++)
+        for (int z = -radius; z <= radius; z++)
+            for (int y = m_Settings.minY; y <= m_Settings.maxY; y++)
+            {
+                const glm::ivec3 coord(center.x + x, y, center.y + z);
+                if (InLoadRadius(coord) && m_World.GetChunk(coord) == nullptr)
+                    m_LoadQueue.push_back(coord);
+            }
+
+    auto distance = [&](const glm::ivec3& coord)
+    {
+        const glm::ivec2 offset = glm::ivec2(coord.x, coord.z) - center;
+        return offset.x * offset.x + offset.y * offset.y;
+    };
+    std::sort(m_LoadQueue.begin(), m_LoadQueue.end(),
+        [&](const glm::ivec3& a, const glm::ivec3& b) { return distance(a) > distance(b); });
+
+    m_UnloadQueue.clear();
+    m_World.ForEachChunk([&](const Chunk& chunk)
+    {
+        if (!InUnloadRadius(chunk.GetCoord()))
+            m_UnloadQueue.push_back(chunk.GetCoord());
+        else
+            m_World.SetLod(chunk.GetCoord(), GetLod(chunk.GetCoord()));
+    });
+}
+
+std::vector<std::unique_ptr<Chunk>> ChunkStreamer::Update(const glm::vec3& cameraPos)
+{
+    const glm::ivec3 cameraChunk = World::ToChunkCoord(glm::ivec3(glm::floor(cameraPos)));
+    const glm::ivec2 center(cameraChunk.x, cameraChunk.z);
+    if (!m_HasCenter || center != m_Center)
+        Recenter(center);
+
+    std::vector<std::unique_ptr<Chunk>> freed;
+    uint32_t budget = m_Settings.budget;
+
+    // Free first so new chunks find their slots empty
+    while (budget > 0 && !m_UnloadQueue.empty())
+    {
+        if (std::unique_ptr<Chunk> chunk = m_World.RemoveChunk(m_UnloadQueue.back()))
+        {
+            freed.push_back(std::move(chunk));
+            budget--;
+        }
+        m_UnloadQueue.pop_back();
+    }
+
+    while (budget > 0 && !m_LoadQueue.empty())
+    {
+        const glm::ivec3 coord = m_LoadQueue.back();
+
+        // Slot is still held by a chunk past unload radius that hasn't been freed yet
+        if (Chunk* occupant = m_World.GetSlot(coord); occupant != nullptr && occupant->GetCoord() != coord)
+        {
+            freed.push_back(m_World.RemoveChunk(occupant->GetCoord()));
+            budget--;
+            continue;
+        }
+
+        m_World.CreateChunk(coord);
+        m_World.SetLod(coord, GetLod(coord));
+        m_LoadQueue.pop_back();
+        budget--;
+    }
+
+    return freed;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "World.hpp"
+
+struct StreamingSettings
+{
+    int         radius      = 4;    // chunks loaded within this horizontal distance of camera chunk
+    int         minY        = 0;    // vertical chunk range kept loaded in every column
+    int         maxY        = 0;
+    uint32_t    budget      = 4;    // chunks created or freed per frame
+    int         lodDistance = 4;    // every this many chunks away from camera chunk mesh detail halves
+
+    /// Ring extent of World able to hold every chunk up to unload radius without slot collisions
+    glm::ivec3 GetWorldExtent() const;
+};
+
+/// Keeps columns of chunks around camera loaded. Chunks are freed once they are more than
+/// one chunk past load radius, so moving back and forth across a chunk border doesn't thrash
+class ChunkStreamer
+{
+    private:
+        World&                      m_World;
+        StreamingSettings           m_Settings;
+        glm::ivec2                  m_Center            = { 0, 0 };
+        bool                        m_HasCenter         = false;
+        std::vector<glm::ivec3>     m_LoadQueue;        // sorted farthest first, nearest is popped from back
+        std::vector<glm::ivec3>     m_UnloadQueue;
+
+        bool InLoadRadius(const glm::ivec3& coord) const;
+        bool InUnloadRadius(const glm::ivec3& coord) const;
+        int GetLod(const glm::ivec3& coord) const;
+        void Recenter(const glm::ivec2& center);
+    public:
+        ChunkStreamer(World& world, const StreamingSettings& settings);
+
+        /// Create and free up to budget chunks around camera position, pick LOD of loaded chunks by their distance.
+        /// Returns freed chunks, their models have to be unloaded before they are released
+        std::vector<std::unique_ptr<Chunk>> Update(const glm::vec3& cameraPos);
+
+        const StreamingSettings& GetSettings() const { return m_Settings; }
+        size_t GetQueuedCount() const { return m_LoadQueue.size() + m_UnloadQueue.size(); }
+};
@@ -0,0 +1,71 @@
+#include "FaceConnectivity.hpp"
+
+#include <array>
+
+static_assert(chunkVolume <= 65536, "Flood fill stack holds 16-bit voxel indices");
+
+FaceConnectivity FaceConnectivity::Open()
+{
+    FaceConnectivity connectivity;
+    connectivity.m_Pairs = (1ull << 36) - 1;
+    return connectivity;
+}
+
+FaceConnectivity FaceConnectivity::Compute(const ChunkData& data)
+{
+    if (data.IsUniform())
+        return data.IsEmpty() ? Open() : FaceConnectivity();
+
+    const int size = chunkSize;
+    const int volume = chunkVolume;
+    std::array<uint8_t, volume> open;
+    for (int x = 0; x < size; x++)
+        for (int y = 0; y < size; y++)
+            for (int z = 0; z < size; z++)
+                open[VoxelIndex({ x, y, z })] = data.At({ x, y, z }).type == Block::Type::Air ? 1 : 0;
+
+    // Bit per BlockFace the voxel lies on
+    auto facesOf = [&](uint32_t voxel)
+    {
+        const glm::ivec3 p = VoxelPosition(voxel);
+        return static_cast<uint8_t>((p.x == 0) << 0 | (p.x == size - 1) << 1 | (p.y == 0) << 2 | (p.y == size - 1) << 3 | (p.z == 0) << 4 | (p.z == size - 1) << 5);
+    };
+
+    FaceConnectivity connectivity;
+    std::array<uint16_t, volume> stack;
+    for (uint32_t start = 0; start < chunkVolume; start++)
+    {
+        // Air pockets not touching any face can't connect faces
+        if (!open[start] || facesOf(start) == 0)
+            continue;
+
+        uint8_t faces = 0;
+        int top = 0;
+        stack[top++] = static_cast<uint16_t>(start);
+        open[start] = 0;
+        while (top > 0)
+        {
+            const uint32_t voxel = stack[--top];
+            const uint8_t onFaces = facesOf(voxel);
+            faces |= onFaces;
+
+            for (int f = 0; f < 6; f++)
+            {
+                if ((onFaces & (1u << f)) != 0)
+                    continue;
+                const uint32_t next = VoxelStep(voxel, static_cast<BlockFace>(f));
+                if (open[next])
+                {
+                    open[next] = 0;
+                    stack[top++] = static_cast<uint16_t>(next);
+                }
+            }
+        }
+
+        for (int f = 0; f < 6; f++)
+            if ((faces & (1u << f)) != 0)
+                connectivity.m_Pairs |= static_cast<uint64_t>(faces) << (f * 6);
+    }
+
+    return connectivity;
+}
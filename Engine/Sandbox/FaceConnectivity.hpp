@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Block.hpp"
+#include "ChunkData.hpp"
+
+/// Pairs of chunk faces joined by a path through Air inside chunk, so looking in through one face may show
+/// what lies past the other. Found by flood fill over Air voxels, used to skip chunks hidden behind solid ground
+class FaceConnectivity
+{
+    private:
+        uint64_t    m_Pairs = 0;    // bit a * 6 + b set when faces a and b are connected, stored both ways
+    public:
+        static FaceConnectivity Compute(const ChunkData& data);
+        /// Every face sees every other, used while real connectivity isn't known
+        static FaceConnectivity Open();
+
+        bool Connects(BlockFace a, BlockFace b) const { return (m_Pairs >> (static_cast<int>(a) * 6 + static_cast<int>(b)) & 1) != 0; }
+        /// Bit per BlockFace connected to given face
+        uint8_t GetConnected(BlockFace face) const { return static_cast<uint8_t>((m_Pairs >> (static_cast<int>(face) * 6)) & 63); }
+
+        bool operator==(const FaceConnectivity& other) const { return m_Pairs == other.m_Pairs; }
+        bool operator!=(const FaceConnectivity& other) const { return m_Pairs != other.m_Pairs; }
+};
@@ -0,0 +1,300 @@
+#include "LightPass.hpp"
+
+#include <algorithm>
+
+static_assert(chunkSize <= 64, "Changed layers of chunk must fit 64-bit mask");
+
+static const int bottomFace = static_cast<int>(BlockFace::Bottom);
+
+LightPass::LightPass(std::vector<RegionChunk>&& chunks, std::vector<glm::ivec3>&& changedBlocks, std::vector<glm::ivec3>&& newChunks)
+    : m_ChangedBlocks(std::move(changedBlocks)), m_NewChunks(std::move(newChunks))
+{
+    m_Chunks.resize(chunks.size());
+    for (uint32_t i = 0; i < chunks.size(); i++)
+    {
+        const RegionChunk& source = chunks[i];
+        Grid& grid = m_Chunks[i];
+        grid.coord  = source.coord;
+        grid.frozen = source.frozen;
+        grid.light  = source.data.CopyLight();
+        m_ChunkIndex[source.coord] = i;
+
+        // Frozen chunks are only read for light, light never flows into them
+        if (grid.frozen)
+            continue;
+
+        grid.before = grid.light;
+        grid.opaque.resize(chunkVolume);
+        grid.emission.resize(chunkVolume);
+        for (int x = 0; x < chunkSize; x++)
+            for (int y = 0; y < chunkSize; y++)
+                for (int z = 0; z < chunkSize; z++)
+                {
+                    const uint32_t voxel = VoxelIndex({ x, y, z });
+                    const Block::Type type = source.data.At({ x, y, z }).type;
+                    grid.opaque[voxel]      = type != Block::Type::Air;
+                    grid.emission[voxel]    = Block::GetEmission(type);
+                }
+    }
+
+    for (Grid& grid : m_Chunks)
+    {
+        for (int f = 0; f < 6; f++)
+            grid.neighbors[f] = FindChunk(grid.coord + GetFaceNormal(static_cast<BlockFace>(f)));
+        grid.openSky = grid.neighbors[static_cast<int>(BlockFace::Top)] < 0;
+    }
+}
+
+int32_t LightPass::FindChunk(const glm::ivec3& coord) const
+{
+    const uint32_t* index = m_ChunkIndex.Find(coord);
+    return index != nullptr ? static_cast<int32_t>(*index) : -1;
+}
+
+bool LightPass::Step(const Voxel& voxel, int face, Voxel& next) const
+{
+    // Faces come in (negative, positive) pairs per axis
+    const int axis      = face >> 1;
+    const bool positive = (face & 1) != 0;
+    const int coord     = VoxelCoord(voxel.index, axis);
+
+    if (positive ? coord == chunkSize - 1 : coord == 0)
+    {
+        const int32_t neighbor = m_Chunks[voxel.chunk].neighbors[face];
+        if (neighbor < 0)
+            return false;
+
+        // Wrap to the opposite side of neighbor chunk
+        next.chunk = static_cast<uint32_t>(neighbor);
+        next.index = VoxelWithCoord(voxel.index, axis, positive ? 0 : chunkSize - 1);
+        return true;
+    }
+
+    next.chunk = voxel.chunk;
+    next.index = VoxelStep(voxel.index, static_cast<BlockFace>(face));
+    return true;
+}
+
+uint8_t LightPass::GetLevel(const Voxel& voxel, bool sky) const
+{
+    const uint8_t light = m_Chunks[voxel.chunk].light[voxel.index];
+    return sky ? GetSkyLight(light) : GetBlockLight(light);
+}
+
+void LightPass::SetLevel(const Voxel& voxel, bool sky, uint8_t level)
+{
+    uint8_t& light = m_Chunks[voxel.chunk].light[voxel.index];
+    light = sky ? PackLight(level, GetBlockLight(light)) : PackLight(GetSkyLight(light), level);
+}
+
+uint8_t LightPass::GetSourceLevel(const Voxel& voxel, bool sky) const
+{
+    const Grid& grid = m_Chunks[voxel.chunk];
+    if (!sky)
+        return grid.emission[voxel.index];
+
+    const bool topLayer = VoxelCoord(voxel.index, 1) == chunkSize - 1;
+    return grid.openSky && topLayer && !grid.opaque[voxel.index] ? maxLightLevel : 0;
+}
+
+void LightPass::SeedChangedBlock(const glm::ivec3& pos, bool sky)
+{
+    const glm::ivec3 coord(BlockToChunk(pos.x), BlockToChunk(pos.y), BlockToChunk(pos.z));
+    const int32_t chunk = FindChunk(coord);
+    if (chunk < 0 || m_Chunks[chunk].frozen)
+        return;
+
+    const glm::ivec3 local = pos - coord * chunkSize;
+    const Voxel voxel { static_cast<uint32_t>(chunk), VoxelIndex(local) };
+
+    // Light that passed through or came from old block goes first
+    if (const uint8_t level = GetLevel(voxel, sky))
+    {
+        SetLevel(voxel, sky, 0);
+        m_RemovalQueue.push_back({ voxel, level });
+    }
+
+    if (const uint8_t source = GetSourceLevel(voxel, sky))
+    {
+        SetLevel(voxel, sky, source);
+        m_PropagationQueue.push_back(voxel);
+    }
+
+    // Neighbors may now shine into the block
+    for (int f = 0; f < 6; f++)
+    {
+        Voxel next;
+        if (Step(voxel, f, next))
+            m_PropagationQueue.push_back(next);
+    }
+}
+
+void LightPass::SeedNewChunk(uint32_t chunk, bool sky)
+{
+    if (m_Chunks[chunk].frozen)
+        return;
+
+    for (uint32_t index = 0; index < chunkVolume; index++)
+    {
+        const Voxel voxel { chunk, index };
+        if (const uint8_t source = GetSourceLevel(voxel, sky))
+        {
+            SetLevel(voxel, sky, source);
+            m_PropagationQueue.push_back(voxel);
+        }
+    }
+
+    for (int f = 0; f < 6; f++)
+    {
+        const int axis = f >> 1;
+        const int depth = (f & 1) != 0 ? chunkSize - 1 : 0;
+        for (uint32_t index = 0; index < chunkVolume; index++)
+        {
+            if (VoxelCoord(index, axis) != depth)
+                continue;
+
+            Voxel next;
+            if (!Step({ chunk, index }, f, next))
+                continue;
+
+            // Light of loaded neighbors flows in
+            if (GetLevel(next, sky) > 0)
+                m_PropagationQueue.push_back(next);
+
+            // Chunk below saw open sky until now, its sky light has to be built again from what reaches it
+            if (sky && f == bottomFace && !m_Chunks[next.chunk].frozen)
+            {
+                if (const uint8_t level = GetLevel(next, sky))
+                {
+                    SetLevel(next, sky, 0);
+                    m_RemovalQueue.push_back({ next, level });
+                }
+            }
+        }
+    }
+}
+
+void LightPass::RemoveLight(bool sky)
+{
+    for (size_t head = 0; head < m_RemovalQueue.size(); head++)
+    {
+        const Removal removal = m_RemovalQueue[head];
+        for (int f = 0; f < 6; f++)
+        {
+            Voxel next;
+            if (!Step(removal.voxel, f, next))
+                continue;
+
+            const uint8_t level = GetLevel(next, sky);
+            if (level == 0)
+                continue;
+
+            // Sky light falls straight down without fading, so full sky light below came from removed voxel too
+            const bool fellFrom = sky && f == bottomFace && removal.level == maxLightLevel && level == maxLightLevel;
+            if ((level < removal.level || fellFrom) && !m_Chunks[next.chunk].frozen)
+            {
+                SetLevel(next, sky, 0);
+                m_RemovalQueue.push_back({ next, level });
+
+                if (const uint8_t source = GetSourceLevel(next, sky))
+                {
+                    SetLevel(next, sky, source);
+                    m_PropagationQueue.push_back(next);
+                }
+            }
+            else
+            {
+                // Lit by something else, spreads back into removed area
+                m_PropagationQueue.push_back(next);
+            }
+        }
+    }
+    m_RemovalQueue.clear();
+}
+
+void LightPass::PropagateLight(bool sky)
+{
+    for (size_t head = 0; head < m_PropagationQueue.size(); head++)
+    {
+        const Voxel voxel = m_PropagationQueue[head];
+        const uint8_t level = GetLevel(voxel, sky);
+        if (level == 0)
+            continue;
+
+        for (int f = 0; f < 6; f++)
+        {
+            Voxel next;
+            if (!Step(voxel, f, next))
+                continue;
+
+            const Grid& grid = m_Chunks[next.chunk];
+            if (grid.frozen || grid.opaque[next.index])
+                continue;
+
+            const uint8_t target = (sky && f == bottomFace && level == maxLightLevel) ? maxLightLevel : level - 1;
+            if (GetLevel(next, sky) < target)
+            {
+                SetLevel(next, sky, target);
+                m_PropagationQueue.push_back(next);
+            }
+        }
+    }
+    m_PropagationQueue.clear();
+}
+
+void LightPass::Run()
+{
+    for (bool sky : { true, false })
+    {
+        for (const glm::ivec3& pos : m_ChangedBlocks)
+            SeedChangedBlock(pos, sky);
+
+        for (const glm::ivec3& coord : m_NewChunks)
+        {
+            const int32_t chunk = FindChunk(coord);
+            if (chunk >= 0)
+                SeedNewChunk(static_cast<uint32_t>(chunk), sky);
+        }
+
+        RemoveLight(sky);
+        PropagateLight(sky);
+    }
+}
+
+std::vector<LightPass::Result> LightPass::TakeResults()
+{
+    std::vector<Result> results;
+    for (Grid& grid : m_Chunks)
+    {
+        if (grid.frozen)
+            continue;
+
+        Result result { grid.coord, {}, 0, 0 };
+        for (int x = 0; x < chunkSize; x++)
+            for (int y = 0; y < chunkSize; y++)
+                for (int z = 0; z < chunkSize; z++)
+                {
+                    const uint32_t voxel = VoxelIndex({ x, y, z });
+                    if (grid.light[voxel] == grid.before[voxel])
+                        continue;
+
+                    result.changedLayers |= 1ull << y;
+                    const int borders[3][2] = { { x, 0 }, { y, 2 }, { z, 4 } };
+                    for (const auto& border : borders)
+                    {
+                        if (border[0] == 0)
+                            result.changedBorders |= 1u << border[1];
+                        if (border[0] == chunkSize - 1)
+                            result.changedBorders |= 1u << (border[1] + 1);
+                    }
+                }
+
+        if (result.changedLayers == 0)
+            continue;
+
+        result.light = std::move(grid.light);
+        results.push_back(std::move(result));
+    }
+
+    return results;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "ChunkData.hpp"
+#include "ChunkMap.hpp"
+
+/// Chunks a light pass reaches further than this many chunks from a change, light fades out over maxLightLevel blocks
+static const int lightRadiusChunks = (maxLightLevel + chunkSize - 1) / chunkSize;
+
+/// One batched update of sky and block light over a region of chunks, done with queue based flood fill.
+/// Changed voxels first remove light that depended on them, then light left around removed area and new sources
+/// flow back in. Frozen chunks at region edge feed light in but are never written, so cost depends only on region size.
+/// Works on its own copies of chunk data, so it can run on any thread
+class LightPass
+{
+    public:
+        struct RegionChunk
+        {
+            glm::ivec3  coord;
+            ChunkData   data;
+            bool        frozen;
+        };
+
+        struct Result
+        {
+            glm::ivec3              coord;
+            std::vector<uint8_t>    light;          // light of every voxel, ordered by VoxelIndex
+            uint64_t                changedLayers;  // bit y set when any voxel in layer y changed
+            uint8_t                 changedBorders; // bit per BlockFace whose outermost layer changed
+        };
+    private:
+        struct Voxel
+        {
+            uint32_t    chunk;
+            uint32_t    index;
+        };
+
+        struct Removal
+        {
+            Voxel       voxel;
+            uint8_t     level;
+        };
+
+        /// Dense copy of one region chunk
+        struct Grid
+        {
+            glm::ivec3              coord;
+            bool                    frozen;
+            bool                    openSky;        // nothing loaded above, top layer is lit by sky
+            int32_t                 neighbors[6];   // region chunk across each face, -1 if none
+            std::vector<uint8_t>    light;
+            std::vector<uint8_t>    before;
+            std::vector<uint8_t>    opaque;
+            std::vector<uint8_t>    emission;
+        };
+
+        std::vector<Grid>                       m_Chunks;
+        ChunkMap<uint32_t>                      m_ChunkIndex;
+        std::vector<glm::ivec3>                 m_ChangedBlocks;
+        std::vector<glm::ivec3>                 m_NewChunks;
+
+        std::vector<Removal>                    m_RemovalQueue;
+        std::vector<Voxel>                      m_PropagationQueue;
+
+        int32_t FindChunk(const glm::ivec3& coord) const;
+
+        /// Voxel next to given one across face, false if it lies outside region
+        bool Step(const Voxel& voxel, int face, Voxel& next) const;
+        uint8_t GetLevel(const Voxel& voxel, bool sky) const;
+        void SetLevel(const Voxel& voxel, bool sky, uint8_t level);
+        /// Level voxel gets on its own, from emission or from open sky above
+        uint8_t GetSourceLevel(const Voxel& voxel, bool sky) const;
+
+        void SeedChangedBlock(const glm::ivec3& pos, bool sky);
+        void SeedNewChunk(uint32_t chunk, bool sky);
+        void RemoveLight(bool sky);
+        void PropagateLight(bool sky);
+    public:
+        /// changedBlocks are world positions whose block changed, newChunks are chunk coordinates lit for the first time.
+        /// Every chunk next to a non-frozen one must be in region if it's loaded
+        LightPass(std::vector<RegionChunk>&& chunks, std::vector<glm::ivec3>&& changedBlocks, std::vector<glm::ivec3>&& newChunks);
+
+        void Run();
+
+        /// Non-frozen chunks whose light changed
+        std::vector<Result> TakeResults();
+        const std::vector<glm::ivec3>& GetNewChunks() const { return m_NewChunks; }
+        size_t GetChunkCount() const { return m_Chunks.size(); }
+};
@@ -0,0 +1,72 @@
+#include "LightWorker.hpp"
+#include "Base.hpp"
+
+LightWorker::LightWorker()
+{
+    m_Thread = std::thread(&LightWorker::Run, this);
+}
+
+LightWorker::~LightWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Condition.notify_all();
+    m_Thread.join();
+}
+
+void LightWorker::Submit(std::unique_ptr<LightPass> pass)
+{
+    ET_ASSERT(!m_Busy);
+    m_Busy = true;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Queued = std::move(pass);
+    }
+    m_Condition.notify_all();
+}
+
+std::unique_ptr<LightPass> LightWorker::Collect()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex, std::try_to_lock);
+    if (!lock.owns_lock() || m_Finished == nullptr)
+        return nullptr;
+
+    m_Busy = false;
+    return std::move(m_Finished);
+}
+
+std::unique_ptr<LightPass> LightWorker::Wait()
+{
+    if (!m_Busy)
+        return nullptr;
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Condition.wait(lock, [this]() { return m_Finished != nullptr; });
+    m_Busy = false;
+    return std::move(m_Finished);
+}
+
+void LightWorker::Run()
+{
+    while (true)
+    {
+        std::unique_ptr<LightPass> pass;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Condition.wait(lock, [this]() { return m_Stop || m_Queued != nullptr; });
+            if (m_Stop)
+                return;
+            pass = std::move(m_Queued);
+        }
+
+        pass->Run();
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Finished = std::move(pass);
+        }
+        m_Condition.notify_all();
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "LightPass.hpp"
+
+/// Thread running light passes one at a time off the render thread.
+/// Passes depend on light left by the previous one, so at most one is ever in flight
+class LightWorker
+{
+    private:
+        std::thread                 m_Thread;
+        std::mutex                  m_Mutex;
+        std::condition_variable     m_Condition;
+        std::unique_ptr<LightPass>  m_Queued;
+        std::unique_ptr<LightPass>  m_Finished;
+        bool                        m_Stop      = false;
+        bool                        m_Busy      = false;    // submitted pass not collected yet, render thread only
+
+        void Run();
+    public:
+        LightWorker();
+        ~LightWorker();
+
+        void Submit(std::unique_ptr<LightPass> pass);
+        /// Finished pass, nullptr if it's still running. Never waits
+        std::unique_ptr<LightPass> Collect();
+        /// Wait for submitted pass to finish
+        std::unique_ptr<LightPass> Wait();
+
+        bool IsBusy() const { return m_Busy; }
+};
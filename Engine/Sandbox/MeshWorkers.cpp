@@ -0,0 +1,81 @@
+#include "MeshWorkers.hpp"
+#include "Base.hpp"
+
+MeshWorkers::MeshWorkers(uint32_t threadCount /* = 0 */)
+{
+    if (threadCount == 0)
+    {
+        const uint32_t cores = std::thread::hardware_concurrency();
+        threadCount = cores > 1 ? cores - 1 : 1;
+    }
+
+    for (uint32_t i = 0; i < threadCount; i++)
+        m_Threads.emplace_back(&MeshWorkers::Run, this);
+
+    ET_TRACE("Mesh workers started:", threadCount);
+}
+
+MeshWorkers::~MeshWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_JobsMutex);
+        m_Stop = true;
+    }
+    m_JobsCondition.notify_all();
+
+    for (auto& thread : m_Threads)
+        thread.join();
+}
+
+void MeshWorkers::Submit(Job&& job)
+{
+    m_Pending++;
+    {
+        std::lock_guard<std::mutex> lock(m_JobsMutex);
+        m_Jobs.push_back(std::move(job));
+    }
+    m_JobsCondition.notify_one();
+}
+
+std::vector<MeshWorkers::Result> MeshWorkers::Collect()
+{
+    std::vector<Result> results;
+
+    std::unique_lock<std::mutex> lock(m_ResultsMutex, std::try_to_lock);
+    if (!lock.owns_lock())
+        return results;
+
+    results.swap(m_Results);
+    m_Pending -= results.size();
+
+    return results;
+}
+
+void MeshWorkers::Run()
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_JobsMutex);
+            m_JobsCondition.wait(lock, [this]() { return m_Stop || !m_Jobs.empty(); });
+            if (m_Stop)
+                return;
+
+            job = std::move(m_Jobs.front());
+            m_Jobs.pop_front();
+        }
+
+        // Chunk was changed again after submit, newer job is already queued
+        if (job.latestRevision->load() != job.revision)
+        {
+            m_Pending--;
+            continue;
+        }
+
+        Result result { job.coord, job.revision, job.latestRevision, Mesher::BuildSections(job.data, job.borders, job.mode, job.lod), FaceConnectivity::Compute(job.data) };
+
+        std::lock_guard<std::mutex> lock(m_ResultsMutex);
+        m_Results.push_back(std::move(result));
+    }
+}
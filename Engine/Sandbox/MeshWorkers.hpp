@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "ChunkData.hpp"
+#include "FaceConnectivity.hpp"
+#include "Mesher.hpp"
+
+/// Pool of threads building chunk meshes off the render thread.
+/// Jobs carry their own copy of block data, results are handed back through Collect
+class MeshWorkers
+{
+    public:
+        struct Job
+        {
+            glm::ivec3                              coord;
+            uint32_t                                revision;
+            std::shared_ptr<std::atomic<uint32_t>>  latestRevision; // job is skipped once chunk moves past revision
+            ChunkData                               data;
+            ChunkBorders                            borders;
+            MeshMode                                mode;
+            int                                     lod;
+        };
+
+        struct Result
+        {
+            glm::ivec3                              coord;
+            uint32_t                                revision;
+            std::shared_ptr<std::atomic<uint32_t>>  latestRevision; // counter of chunk job was made for, a reloaded chunk has its own
+            std::vector<ChunkMesh>                  sections;
+            FaceConnectivity                        connectivity;
+        };
+    private:
+        std::vector<std::thread>    m_Threads;
+
+        std::mutex                  m_JobsMutex;
+        std::condition_variable     m_JobsCondition;
+        std::deque<Job>             m_Jobs;
+        bool                        m_Stop = false;
+
+        std::mutex                  m_ResultsMutex;
+        std::vector<Result>         m_Results;
+
+        std::atomic<size_t>         m_Pending { 0 };
+
+        void Run();
+    public:
+        /// threadCount = 0 picks hardware concurrency minus render thread
+        MeshWorkers(uint32_t threadCount = 0);
+        ~MeshWorkers();
+
+        void Submit(Job&& job);
+        /// Take finished meshes, never waits for workers. Returns nothing if results are being published right now
+        std::vector<Result> Collect();
+
+        /// Jobs submitted but not collected yet
+        size_t GetPendingCount() const { return m_Pending.load(); }
+};
@@ -0,0 +1,433 @@
+#include "Mesher.hpp"
+
+#include <algorithm>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+struct FaceDesc
+{
+    glm::ivec3  normal;
+    int         axis;           // axis along normal
+    int         uAxis;          // in-plane axes, greedy merge grows along u first
+    int         vAxis;
+    glm::ivec3  corners[4];     // -1 = min side, +1 = max side of covered blocks
+};
+
+// Greedy mask entry: block type in low byte, corner AO and light in front of face above it, 0 = no face
+using FaceKey = uint32_t;
+
+/// Index of lowest set bit, bits must not be 0
+static int LowestBit(uint64_t bits)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+// Indexed by BlockFace. Corner order matches indices { 0, 1, 2, 2, 1, 3 }.
+// Texture axes live in shader.vert, keep both in sync
+static const FaceDesc faceDescs[] =
+{
+    // Left
+    { { -1, 0, 0 }, 0, 2, 1, { { -1, -1, -1 }, { -1, -1, 1 }, { -1, 1, -1 }, { -1, 1, 1 } } },
+    // Right
+    { { 1, 0, 0 },  0, 2, 1, { { 1, -1, 1 }, { 1, -1, -1 }, { 1, 1, 1 }, { 1, 1, -1 } } },
+    // Bottom
+    { { 0, -1, 0 }, 1, 2, 0, { { 1, -1, -1 }, { 1, -1, 1 }, { -1, -1, -1 }, { -1, -1, 1 } } },
+    // Top
+    { { 0, 1, 0 },  1, 0, 2, { { -1, 1, -1 }, { -1, 1, 1 }, { 1, 1, -1 }, { 1, 1, 1 } } },
+    // Back
+    { { 0, 0, -1 }, 2, 0, 1, { { 1, -1, -1 }, { -1, -1, -1 }, { 1, 1, -1 }, { -1, 1, -1 } } },
+    // Front
+    { { 0, 0, 1 },  2, 0, 1, { { -1, -1, 1 }, { 1, -1, 1 }, { -1, 1, 1 }, { 1, 1, 1 } } },
+};
+
+Mesher::Mesher(const ChunkData& data, const ChunkBorders& borders)
+    : m_Data(data), m_Borders(borders)
+{
+    BuildOpaqueRows();
+    BuildFaceRows();
+}
+
+ChunkMesh Mesher::Build(const ChunkData& data, const ChunkBorders& borders, MeshMode mode, int lod /* = 0 */)
+{
+    if (!HasFaces(data, borders))
+        return {};
+    if (lod == 0)
+        return Mesher(data, borders).Generate(mode, 0, chunkSize);
+
+    const ChunkData coarse = data.Downsample(GetLodScale(lod));
+    return Mesher(coarse, borders).Generate(mode, 0, chunkSize);
+}
+
+ChunkMesh Mesher::BuildSection(const ChunkData& data, const ChunkBorders& borders, MeshMode mode, int section)
+{
+    if (!HasFaces(data, borders))
+        return {};
+    return Mesher(data, borders).Generate(mode, section * meshSectionHeight, (section + 1) * meshSectionHeight);
+}
+
+std::vector<ChunkMesh> Mesher::BuildSections(const ChunkData& data, const ChunkBorders& borders, MeshMode mode, int lod /* = 0 */)
+{
+    if (!HasFaces(data, borders))
+        return std::vector<ChunkMesh>(meshSectionCount);
+
+    std::vector<ChunkMesh> sections;
+    sections.reserve(meshSectionCount);
+    if (lod > 0)
+    {
+        sections.push_back(Build(data, borders, mode, lod));
+        sections.resize(meshSectionCount);
+        return sections;
+    }
+
+    // Opaque rows are shared by all sections
+    Mesher mesher(data, borders);
+    for (int section = 0; section < meshSectionCount; section++)
+        sections.push_back(mesher.Generate(mode, section * meshSectionHeight, (section + 1) * meshSectionHeight));
+
+    return sections;
+}
+
+ChunkClass Mesher::Classify(const ChunkData& data, const ChunkBorders& borders)
+{
+    if (!data.IsUniform())
+        return ChunkClass::Mixed;
+    if (data.IsEmpty())
+        return ChunkClass::Empty;
+
+    // Unloaded neighbor counts as Air
+    for (const std::vector<Block::Type>& layer : borders.layers)
+    {
+        if (layer.empty() || std::find(layer.begin(), layer.end(), Block::Type::Air) != layer.end())
+            return ChunkClass::FullExposed;
+    }
+    return ChunkClass::FullOccluded;
+}
+
+bool Mesher::HasFaces(const ChunkData& data, const ChunkBorders& borders)
+{
+    const ChunkClass kind = Classify(data, borders);
+    return kind != ChunkClass::Empty && kind != ChunkClass::FullOccluded;
+}
+
+ChunkMesh Mesher::Generate(MeshMode mode, int minY, int maxY)
+{
+    m_MinY = minY;
+    m_MaxY = maxY;
+    m_Mesh = {};
+
+    if (mode == MeshMode::Greedy)
+        GenerateGreedy();
+    else
+        GenerateNaive();
+
+    return std::move(m_Mesh);
+}
+
+void Mesher::BuildOpaqueRows()
+{
+    m_OpaqueRowsX.assign(m_PaddedSize * m_PaddedSize, 0);
+    m_OpaqueRowsY.assign(m_PaddedSize * m_PaddedSize, 0);
+    m_OpaqueRowsZ.assign(m_PaddedSize * m_PaddedSize, 0);
+
+    auto setOpaque = [&](const glm::ivec3& p)
+    {
+        m_OpaqueRowsX[(p.y + 1) * m_PaddedSize + p.z + 1] |= 1ull << (p.x + 1);
+        m_OpaqueRowsY[(p.x + 1) * m_PaddedSize + p.z + 1] |= 1ull << (p.y + 1);
+        m_OpaqueRowsZ[(p.x + 1) * m_PaddedSize + p.y + 1] |= 1ull << (p.z + 1);
+    };
+
+    if (m_Data.IsUniform())
+    {
+        const Block::Type type = m_Data.At({ 0, 0, 0 }).type;
+        m_Blocks.assign(chunkVolume, type);
+
+        // Solid chunk fills every row of its own blocks
+        if (type != Block::Type::Air)
+        {
+            const uint64_t full = ((1ull << chunkSize) - 1) << 1;
+            for (int a = 1; a <= chunkSize; a++)
+                for (int b = 1; b <= chunkSize; b++)
+                {
+                    m_OpaqueRowsX[a * m_PaddedSize + b] = full;
+                    m_OpaqueRowsY[a * m_PaddedSize + b] = full;
+                    m_OpaqueRowsZ[a * m_PaddedSize + b] = full;
+                }
+        }
+    }
+    else
+    {
+        m_Blocks.resize(chunkVolume);
+        for (int x = 0; x < chunkSize; x++)
+            for (int y = 0; y < chunkSize; y++)
+                for (int z = 0; z < chunkSize; z++)
+                {
+                    const Block::Type type = m_Data.At({ x, y, z }).type;
+                    m_Blocks[VoxelIndex({ x, y, z })] = type;
+                    if (type != Block::Type::Air)
+                        setOpaque({ x, y, z });
+                }
+    }
+
+    // Blocks of neighbor chunks touching each face. Padding along chunk edges lies in diagonal chunks and stays empty
+    for (int f = 0; f < 6; f++)
+    {
+        if (m_Borders.layers[f].empty())
+            continue;
+
+        const BlockFace face = static_cast<BlockFace>(f);
+        const glm::ivec3 normal = GetFaceNormal(face);
+        const int axis = faceDescs[f].axis;
+        for (int a = 0; a < chunkSize; a++)
+        {
+            for (int b = 0; b < chunkSize; b++)
+            {
+                glm::ivec3 pos;
+                pos[axis]           = normal[axis] < 0 ? 0 : chunkSize - 1;
+                pos[(axis + 1) % 3] = a;
+                pos[(axis + 2) % 3] = b;
+                if (m_Data.NeighborType(pos, face, m_Borders) != Block::Type::Air)
+                    setOpaque(pos + normal);
+            }
+        }
+    }
+}
+
+void Mesher::BuildFaceRows()
+{
+    const uint64_t chunkBits = ((1ull << chunkSize) - 1) << 1;
+    for (int f = 0; f < 6; f++)
+    {
+        const FaceDesc& desc = faceDescs[f];
+        m_FaceRows[f].assign(chunkSize * chunkSize, 0);
+
+        for (int v = 0; v < chunkSize; v++)
+        {
+            for (int u = 0; u < chunkSize; u++)
+            {
+                glm::ivec3 p(0);
+                p[desc.uAxis] = u;
+                p[desc.vAxis] = v;
+
+                // Row along normal holds every slice of cell (u, v), bit of each block is lined up with its neighbor in front
+                const uint64_t row      = GetOpaqueRow(desc.axis, p);
+                const uint64_t front    = desc.normal[desc.axis] < 0 ? row << 1 : row >> 1;
+                uint64_t visible        = row & ~front & chunkBits;
+
+                // Only set bits are visited, buried and empty cells cost nothing
+                for (; visible != 0; visible &= visible - 1)
+                    m_FaceRows[f][(LowestBit(visible) - 1) * chunkSize + v] |= 1ull << u;
+            }
+        }
+    }
+}
+
+uint64_t Mesher::GetOpaqueRow(int axis, const glm::ivec3& p) const
+{
+    if (axis == 0)
+        return m_OpaqueRowsX[(p.y + 1) * m_PaddedSize + p.z + 1];
+    if (axis == 1)
+        return m_OpaqueRowsY[(p.x + 1) * m_PaddedSize + p.z + 1];
+    return m_OpaqueRowsZ[(p.x + 1) * m_PaddedSize + p.y + 1];
+}
+
+void Mesher::GetRowOcclusion(const FaceDesc& desc, int slice, int v, uint8_t* occlusion) const
+{
+    // Rows v - 1, v, v + 1 of the block layer in front of faces
+    uint64_t rows[3];
+    for (int k = 0; k < 3; k++)
+    {
+        glm::ivec3 p(0);
+        p[desc.axis]  = slice + desc.normal[desc.axis];
+        p[desc.vAxis] = v - 1 + k;
+        rows[k] = GetOpaqueRow(desc.uAxis, p);
+    }
+
+    std::fill(occlusion, occlusion + chunkSize, 0);
+    for (int i = 0; i < 4; i++)
+    {
+        // Line up bit u + 1 of every mask with the neighbor of block u touching corner i
+        const int du = desc.corners[i][desc.uAxis];
+        const int dv = desc.corners[i][desc.vAxis];
+        const uint64_t side     = du > 0 ? rows[1] >> 1 : rows[1] << 1;
+        const uint64_t other    = rows[1 + dv];
+        const uint64_t corner   = du > 0 ? other >> 1 : other << 1;
+
+        // AO = 3 - occupied count, or 0 when both sides are occupied
+        const uint64_t bothSides    = side & other;
+        const uint64_t countLow     = side ^ other ^ corner;
+        const uint64_t countHigh    = bothSides | (corner & (side ^ other));
+        const uint64_t aoLow        = ~countLow & ~bothSides;
+        const uint64_t aoHigh       = ~countHigh & ~bothSides;
+
+        for (int u = 0; u < chunkSize; u++)
+        {
+            const uint32_t ao = static_cast<uint32_t>((aoLow >> (u + 1)) & 1) | static_cast<uint32_t>(((aoHigh >> (u + 1)) & 1) << 1);
+            occlusion[u] |= static_cast<uint8_t>(ao << (2 * i));
+        }
+    }
+}
+
+void Mesher::PushFace(BlockFace face, Block::Type type, const glm::ivec3& min, const glm::ivec3& max, uint8_t occlusion, uint8_t light)
+{
+    const FaceDesc& desc = faceDescs[static_cast<int>(face)];
+    const glm::ivec2 tile = Block::GetAtlasTile(type, face);
+    const uint32_t base = static_cast<uint32_t>(m_Mesh.vertices.size());
+
+    uint32_t ao[4];
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        // Block b spans corner coordinates [b, b + 1]
+        glm::ivec3 corner;
+        for (int axis = 0; axis < 3; axis++)
+            corner[axis] = desc.corners[i][axis] < 0 ? min[axis] : max[axis] + 1;
+
+        ao[i] = (occlusion >> (2 * i)) & 3u;
+        m_Mesh.vertices.push_back(Vertex::Pack(corner, static_cast<uint32_t>(face), i, tile.y * 16 + tile.x, ao[i], light));
+    }
+
+    // Split quad along the diagonal whose corners are lighter in sum, so occlusion interpolates the same way
+    // whichever way quad is turned
+    if (ao[0] + ao[3] > ao[1] + ao[2])
+        m_Mesh.indices.insert(m_Mesh.indices.end(), { 0 + base, 1 + base, 3 + base, 0 + base, 3 + base, 2 + base });
+    else
+        m_Mesh.indices.insert(m_Mesh.indices.end(), { 0 + base, 1 + base, 2 + base, 2 + base, 1 + base, 3 + base });
+}
+
+void Mesher::GenerateNaive()
+{
+    uint8_t occlusion[chunkSize];
+
+    for (int f = 0; f < 6; f++)
+    {
+        const BlockFace face = static_cast<BlockFace>(f);
+        const FaceDesc& desc = faceDescs[f];
+
+        // Slices of horizontal faces are y layers, other faces have y as v
+        const int firstSlice    = desc.axis == 1 ? m_MinY : 0;
+        const int lastSlice     = desc.axis == 1 ? m_MaxY : chunkSize;
+        const int firstRow      = desc.vAxis == 1 ? m_MinY : 0;
+        const int lastRow       = desc.vAxis == 1 ? m_MaxY : chunkSize;
+
+        for (int slice = firstSlice; slice < lastSlice; slice++)
+        {
+            for (int v = firstRow; v < lastRow; v++)
+            {
+                uint64_t faces = m_FaceRows[f][slice * chunkSize + v];
+                if (faces == 0)
+                    continue;
+
+                GetRowOcclusion(desc, slice, v, occlusion);
+                for (; faces != 0; faces &= faces - 1)
+                {
+                    const int u = LowestBit(faces);
+                    glm::ivec3 pos;
+                    pos[desc.axis]  = slice;
+                    pos[desc.uAxis] = u;
+                    pos[desc.vAxis] = v;
+
+                    const Block::Type type = m_Blocks[VoxelIndex(pos)];
+                    PushFace(face, type, pos, pos, occlusion[u], m_Data.NeighborLight(pos, face, m_Borders));
+                }
+            }
+        }
+    }
+}
+
+void Mesher::GenerateGreedy()
+{
+    // Visible face per (u, v) cell of current slice, faces merge only when type and corner AO match
+    std::vector<FaceKey> mask(chunkSize * chunkSize);
+    uint8_t occlusion[chunkSize];
+
+    for (int f = 0; f < 6; f++)
+    {
+        const BlockFace face = static_cast<BlockFace>(f);
+        const FaceDesc& desc = faceDescs[f];
+
+        // Slices of horizontal faces are y layers, other faces have y as v
+        const int firstSlice    = desc.axis == 1 ? m_MinY : 0;
+        const int lastSlice     = desc.axis == 1 ? m_MaxY : chunkSize;
+        const int firstRow      = desc.vAxis == 1 ? m_MinY : 0;
+        const int lastRow       = desc.vAxis == 1 ? m_MaxY : chunkSize;
+
+        for (int slice = firstSlice; slice < lastSlice; slice++)
+        {
+            // Cells without a face stay 0, merging below clears every cell it covers
+            bool sliceVisible = false;
+            for (int v = firstRow; v < lastRow; v++)
+            {
+                uint64_t faces = m_FaceRows[f][slice * chunkSize + v];
+                if (faces == 0)
+                    continue;
+                sliceVisible = true;
+
+                GetRowOcclusion(desc, slice, v, occlusion);
+                for (; faces != 0; faces &= faces - 1)
+                {
+                    const int u = LowestBit(faces);
+                    glm::ivec3 pos;
+                    pos[desc.axis]  = slice;
+                    pos[desc.uAxis] = u;
+                    pos[desc.vAxis] = v;
+
+                    const Block::Type type = m_Blocks[VoxelIndex(pos)];
+                    mask[v * chunkSize + u] = static_cast<FaceKey>(type) | static_cast<FaceKey>(occlusion[u] << 8)
+                        | (m_Data.NeighborLight(pos, face, m_Borders) << 16);
+                }
+            }
+
+            if (!sliceVisible)
+                continue;
+
+            for (int v = firstRow; v < lastRow; v++)
+            {
+                for (int u = 0; u < chunkSize;)
+                {
+                    const FaceKey key = mask[v * chunkSize + u];
+                    if (key == 0)
+                    {
+                        u++;
+                        continue;
+                    }
+
+                    // Grow along u, then add whole rows along v while they match
+                    int width = 1;
+                    while (u + width < chunkSize && mask[v * chunkSize + u + width] == key)
+                        width++;
+
+                    int height = 1;
+                    for (; v + height < chunkSize; height++)
+                    {
+                        bool rowMatches = true;
+                        for (int k = 0; k < width && rowMatches; k++)
+                            rowMatches = mask[(v + height) * chunkSize + u + k] == key;
+                        if (!rowMatches)
+                            break;
+                    }
+
+                    glm::ivec3 min, max;
+                    min[desc.axis]  = max[desc.axis] = slice;
+                    min[desc.uAxis] = u;
+                    max[desc.uAxis] = u + width - 1;
+                    min[desc.vAxis] = v;
+                    max[desc.vAxis] = v + height - 1;
+                    PushFace(face, static_cast<Block::Type>(key & 0xFF), min, max, static_cast<uint8_t>(key >> 8), static_cast<uint8_t>(key >> 16));
+
+                    for (int j = 0; j < height; j++)
+                        for (int k = 0; k < width; k++)
+                            mask[(v + j) * chunkSize + u + k] = 0;
+
+                    u += width;
+                }
+            }
+        }
+    }
+}
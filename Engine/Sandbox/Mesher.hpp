@@ -0,0 +1,106 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "../Renderable.hpp"
+#include "Block.hpp"
+#include "ChunkData.hpp"
+
+enum class MeshMode
+{
+    Naive,      // one quad per visible block face
+    Greedy      // coplanar faces of same type merged into maximal rectangles
+};
+
+/// What chunk mesh will hold, known from block data and borders before meshing
+enum class ChunkClass
+{
+    Empty,          // only Air, no faces
+    FullOccluded,   // one solid type buried in solid neighbor layers, no faces
+    FullExposed,    // one solid type, faces only on sides open to Air or unloaded neighbors
+    Mixed
+};
+
+/// Chunk mesh is split into horizontal sections of blocks, so a block edit only rebuilds its own section
+static const int meshSectionHeight  = 2;
+static const int meshSectionCount   = chunkSize / meshSectionHeight;
+static_assert(chunkSize % meshSectionHeight == 0, "Chunk height must be a whole number of mesh sections");
+static_assert(chunkSize <= Vertex::maxCoordinate, "Chunk corners must fit packed vertex position");
+static_assert(chunkSize + 2 <= 64, "Chunk row with neighbor blocks on both ends must fit 64-bit mask");
+
+/// Level of detail 0 meshes blocks as they are, each further level meshes chunk data downsampled 2x more
+static const int lodCount = 4;
+
+inline int GetLodScale(int lod) { return 1 << lod; }
+
+struct MeshStats
+{
+    size_t vertices = 0;
+    size_t indices  = 0;
+};
+
+struct ChunkMesh
+{
+    std::vector<Vertex>     vertices;
+    std::vector<uint32_t>   indices;
+
+    MeshStats GetStats() const { return { vertices.size(), indices.size() }; }
+};
+
+struct FaceDesc;
+
+/// Builds chunk geometry from block data. Depends only on its inputs, so it is safe to run on worker threads.
+/// Every face corner gets ambient occlusion from the 3 blocks touching it in front of the face,
+/// whole face is lit by light of the voxel in front of it
+class Mesher
+{
+    private:
+        static constexpr int    m_PaddedSize = chunkSize + 2;
+
+        const ChunkData&        m_Data;
+        const ChunkBorders&     m_Borders;
+        int                     m_MinY = 0;     // only blocks with y in [m_MinY, m_MaxY) are meshed
+        int                     m_MaxY = chunkSize;
+        ChunkMesh               m_Mesh;
+        std::vector<Block::Type> m_Blocks;      // decoded once, ordered by VoxelIndex
+        // Opaque blocks of chunk and the layer around it taken from borders, as bit rows along each axis.
+        // Bit u + 1 of a row is block u, so rows can be shifted to look at both neighbors at once
+        std::vector<uint64_t>   m_OpaqueRowsX;  // indexed by (y + 1, z + 1)
+        std::vector<uint64_t>   m_OpaqueRowsY;  // indexed by (x + 1, z + 1)
+        std::vector<uint64_t>   m_OpaqueRowsZ;  // indexed by (x + 1, y + 1)
+        // Per BlockFace, blocks showing that face as bit u of entry (slice, v) in FaceDesc axes
+        std::vector<uint64_t>   m_FaceRows[6];
+
+        Mesher(const ChunkData& data, const ChunkBorders& borders);
+
+        void BuildOpaqueRows();
+        /// Faces of whole rows at once: a block shows a face when it's opaque and the row shifted by one
+        /// toward the face isn't
+        void BuildFaceRows();
+        /// Row along axis through p, p may lie one block outside chunk
+        uint64_t GetOpaqueRow(int axis, const glm::ivec3& p) const;
+        /// Corner AO (2 bits per corner, 3 = unoccluded) of faces of every block in row v of face slice
+        void GetRowOcclusion(const FaceDesc& desc, int slice, int v, uint8_t* occlusion) const;
+
+        /// Push face covering blocks [min, max] (In chunk coordinate system not world global)
+        void PushFace(BlockFace face, Block::Type type, const glm::ivec3& min, const glm::ivec3& max, uint8_t occlusion, uint8_t light);
+
+        ChunkMesh Generate(MeshMode mode, int minY, int maxY);
+        void GenerateNaive();
+        void GenerateGreedy();
+    public:
+        /// Mesh chunk in its local corner coordinates, faces hidden by neighbor border layers are culled.
+        /// Borders must already be downsampled to lod
+        static ChunkMesh Build(const ChunkData& data, const ChunkBorders& borders, MeshMode mode, int lod = 0);
+        /// Mesh only blocks of given section, quads never cross section boundary
+        static ChunkMesh BuildSection(const ChunkData& data, const ChunkBorders& borders, MeshMode mode, int section);
+        /// All sections of chunk, in order. Coarse meshes are never patched, whole mesh goes to first section
+        static std::vector<ChunkMesh> BuildSections(const ChunkData& data, const ChunkBorders& borders, MeshMode mode, int lod = 0);
+
+        /// Quick check of uniform chunks, Empty and FullOccluded ones are never meshed
+        static ChunkClass Classify(const ChunkData& data, const ChunkBorders& borders);
+        static bool HasFaces(const ChunkData& data, const ChunkBorders& borders);
+
+        static int GetSection(int y) { return y / meshSectionHeight; }
+};
@@ -0,0 +1,207 @@
+#include "Noise.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+    #include <immintrin.h>
+#endif
+
+// Thin wrappers over one SIMD register of floats / 32 bit integers, so noise is written once for every width.
+// Integer math wraps like uint32_t in all variants
+namespace
+{
+#if defined(__AVX2__)
+    const int width = 8;
+    using vfloat    = __m256;
+    using vint      = __m256i;
+
+    inline vfloat   Set(float a)                { return _mm256_set1_ps(a); }
+    inline vfloat   Ramp()                      { return _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7); }
+    inline vfloat   Add(vfloat a, vfloat b)     { return _mm256_add_ps(a, b); }
+    inline vfloat   Sub(vfloat a, vfloat b)     { return _mm256_sub_ps(a, b); }
+    inline vfloat   Mul(vfloat a, vfloat b)     { return _mm256_mul_ps(a, b); }
+    inline vfloat   Floor(vfloat a)             { return _mm256_floor_ps(a); }
+    inline vint     ToInt(vfloat a)             { return _mm256_cvttps_epi32(a); }
+    inline vfloat   ToFloat(vint a)             { return _mm256_cvtepi32_ps(a); }
+    inline void     Store(float* out, vfloat a) { _mm256_storeu_ps(out, a); }
+
+    inline vint     SetI(uint32_t a)            { return _mm256_set1_epi32(static_cast<int>(a)); }
+    inline vint     AddI(vint a, vint b)        { return _mm256_add_epi32(a, b); }
+    inline vint     MulI(vint a, vint b)        { return _mm256_mullo_epi32(a, b); }
+    inline vint     XorI(vint a, vint b)        { return _mm256_xor_si256(a, b); }
+    inline vint     AndI(vint a, vint b)        { return _mm256_and_si256(a, b); }
+    template<int N>
+    inline vint     ShrI(vint a)                { return _mm256_srli_epi32(a, N); }
+#elif defined(__SSE4_1__)
+    const int width = 4;
+    using vfloat    = __m128;
+    using vint      = __m128i;
+
+    inline vfloat   Set(float a)                { return _mm_set1_ps(a); }
+    inline vfloat   Ramp()                      { return _mm_setr_ps(0, 1, 2, 3); }
+    inline vfloat   Add(vfloat a, vfloat b)     { return _mm_add_ps(a, b); }
+    inline vfloat   Sub(vfloat a, vfloat b)     { return _mm_sub_ps(a, b); }
+    inline vfloat   Mul(vfloat a, vfloat b)     { return _mm_mul_ps(a, b); }
+    inline vfloat   Floor(vfloat a)             { return _mm_floor_ps(a); }
+    inline vint     ToInt(vfloat a)             { return _mm_cvttps_epi32(a); }
+    inline vfloat   ToFloat(vint a)             { return _mm_cvtepi32_ps(a); }
+    inline void     Store(float* out, vfloat a) { _mm_storeu_ps(out, a); }
+
+    inline vint     SetI(uint32_t a)            { return _mm_set1_epi32(static_cast<int>(a)); }
+    inline vint     AddI(vint a, vint b)        { return _mm_add_epi32(a, b); }
+    inline vint     MulI(vint a, vint b)        { return _mm_mullo_epi32(a, b); }
+    inline vint     XorI(vint a, vint b)        { return _mm_xor_si128(a, b); }
+    inline vint     AndI(vint a, vint b)        { return _mm_and_si128(a, b); }
+    template<int N>
+    inline vint     ShrI(vint a)                { return _mm_srli_epi32(a, N); }
+#else
+    const int width = 1;
+    using vfloat    = float;
+    using vint      = uint32_t;
+
+    inline vfloat   Set(float a)                { return a; }
+    inline vfloat   Ramp()                      { return 0.0f; }
+    inline vfloat   Add(vfloat a, vfloat b)     { return a + b; }
+    inline vfloat   Sub(vfloat a, vfloat b)     { return a - b; }
+    inline vfloat   Mul(vfloat a, vfloat b)     { return a * b; }
+    inline vfloat   Floor(vfloat a)             { return std::floor(a); }
+    inline vint     ToInt(vfloat a)             { return static_cast<uint32_t>(static_cast<int32_t>(a)); }
+    inline vfloat   ToFloat(vint a)             { return static_cast<float>(static_cast<int32_t>(a)); }
+    inline void     Store(float* out, vfloat a) { *out = a; }
+
+    inline vint     SetI(uint32_t a)            { return a; }
+    inline vint     AddI(vint a, vint b)        { return a + b; }
+    inline vint     MulI(vint a, vint b)        { return a * b; }
+    inline vint     XorI(vint a, vint b)        { return a ^ b; }
+    inline vint     AndI(vint a, vint b)        { return a & b; }
+    template<int N>
+    inline vint     ShrI(vint a)                { return a >> N; }
+#endif
+
+    // Lattice axis primes, coordinates are pre-multiplied so neighbor corners only add a prime
+    const uint32_t primeX = 0x27d4eb2du;
+    const uint32_t primeY = 0x165667b1u;
+    const uint32_t primeZ = 0x9e3779b1u;
+
+    /// Lattice value in [-1, 1] for pre-multiplied corner coordinates
+    inline vfloat Lattice(vint seed, vint hx, vint hy, vint hz)
+    {
+        vint h = XorI(XorI(seed, hx), XorI(hy, hz));
+        h = XorI(h, ShrI<15>(h));
+        h = MulI(h, SetI(0x2c1b3c6du));
+        h = XorI(h, ShrI<12>(h));
+        h = MulI(h, SetI(0x297a2d39u));
+        h = XorI(h, ShrI<15>(h));
+
+        // 24 bits convert to float exactly
+        return Sub(Mul(ToFloat(AndI(h, SetI(0xffffffu))), Set(2.0f / 16777215.0f)), Set(1.0f));
+    }
+
+    /// Quintic fade, zero first and second derivative at lattice points
+    inline vfloat Fade(vfloat t)
+    {
+        return Mul(Mul(Mul(t, t), t), Add(Mul(t, Sub(Mul(t, Set(6.0f)), Set(15.0f))), Set(10.0f)));
+    }
+
+    inline vfloat Lerp(vfloat a, vfloat b, vfloat t)
+    {
+        return Add(a, Mul(Sub(b, a), t));
+    }
+
+    vfloat ValueNoise2D(vint seed, vfloat x, vfloat z)
+    {
+        const vfloat fx = Floor(x);
+        const vfloat fz = Floor(z);
+        const vfloat u  = Fade(Sub(x, fx));
+        const vfloat w  = Fade(Sub(z, fz));
+
+        const vint x0 = MulI(ToInt(fx), SetI(primeX)), x1 = AddI(x0, SetI(primeX));
+        const vint z0 = MulI(ToInt(fz), SetI(primeZ)), z1 = AddI(z0, SetI(primeZ));
+        const vint y0 = SetI(0);
+
+        return Lerp(Lerp(Lattice(seed, x0, y0, z0), Lattice(seed, x1, y0, z0), u),
+                    Lerp(Lattice(seed, x0, y0, z1), Lattice(seed, x1, y0, z1), u), w);
+    }
+
+    vfloat ValueNoise3D(vint seed, vfloat x, vfloat y, vfloat z)
+    {
+        const vfloat fx = Floor(x);
+        const vfloat fy = Floor(y);
+        const vfloat fz = Floor(z);
+        const vfloat u  = Fade(Sub(x, fx));
+        const vfloat v  = Fade(Sub(y, fy));
+        const vfloat w  = Fade(Sub(z, fz));
+
+        const vint x0 = MulI(ToInt(fx), SetI(primeX)), x1 = AddI(x0, SetI(primeX));
+        const vint y0 = MulI(ToInt(fy), SetI(primeY)), y1 = AddI(y0, SetI(primeY));
+        const vint z0 = MulI(ToInt(fz), SetI(primeZ)), z1 = AddI(z0, SetI(primeZ));
+
+        const vfloat near = Lerp(Lerp(Lattice(seed, x0, y0, z0), Lattice(seed, x1, y0, z0), u),
+                                 Lerp(Lattice(seed, x0, y1, z0), Lattice(seed, x1, y1, z0), u), v);
+        const vfloat far  = Lerp(Lerp(Lattice(seed, x0, y0, z1), Lattice(seed, x1, y0, z1), u),
+                                 Lerp(Lattice(seed, x0, y1, z1), Lattice(seed, x1, y1, z1), u), v);
+        return Lerp(near, far, w);
+    }
+
+    /// Sum octaves of noise(seed, frequency) sampled along a row, normalized back to [-1, 1]
+    template<typename Sample>
+    void FractalRow(float* out, int count, float z0, float step, const NoiseParams& params, Sample sample)
+    {
+        float amplitudeSum  = 0.0f;
+        float amplitude     = 1.0f;
+        for (int octave = 0; octave < params.octaves; octave++)
+        {
+            amplitudeSum    += amplitude;
+            amplitude       *= params.gain;
+        }
+        const vfloat normalize = Set(1.0f / amplitudeSum);
+
+        for (int i = 0; i < count; i += width)
+        {
+            const vfloat z = Add(Set(z0), Mul(Add(Ramp(), Set(static_cast<float>(i))), Set(step)));
+
+            vfloat sum          = Set(0.0f);
+            float frequency     = params.frequency;
+            amplitude           = 1.0f;
+            for (int octave = 0; octave < params.octaves; octave++)
+            {
+                const vint seed = SetI(params.seed + static_cast<uint32_t>(octave) * 0x68e31da4u);
+                sum = Add(sum, Mul(sample(seed, Set(frequency), Mul(z, Set(frequency))), Set(amplitude)));
+                frequency *= params.lacunarity;
+                amplitude *= params.gain;
+            }
+            sum = Mul(sum, normalize);
+
+            // Tail of row is evaluated full width too, so every sample takes the same path
+            if (count - i >= width)
+            {
+                Store(out + i, sum);
+            }
+            else
+            {
+                float batch[width];
+                Store(batch, sum);
+                std::copy(batch, batch + (count - i), out + i);
+            }
+        }
+    }
+}
+
+const int NoiseBatchWidth = width;
+
+void FractalNoiseRow2D(float* out, int count, float x, float z0, float step, const NoiseParams& params)
+{
+    FractalRow(out, count, z0, step, params, [x](vint seed, vfloat frequency, vfloat z)
+    {
+        return ValueNoise2D(seed, Mul(Set(x), frequency), z);
+    });
+}
+
+void FractalNoiseRow3D(float* out, int count, float x, float y, float z0, float step, const NoiseParams& params)
+{
+    FractalRow(out, count, z0, step, params, [x, y](vint seed, vfloat frequency, vfloat z)
+    {
+        return ValueNoise3D(seed, Mul(Set(x), frequency), Mul(Set(y), frequency), z);
+    });
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+/// Fractal (fBm) value noise parameters, coordinates are in blocks
+struct NoiseParams
+{
+    uint32_t    seed        = 0;
+    float       frequency   = 1.0f;
+    int         octaves     = 1;
+    float       lacunarity  = 2.0f;     // frequency multiplier per octave
+    float       gain        = 0.5f;     // amplitude multiplier per octave
+};
+
+/// Batched noise evaluation. Rows are sampled NoiseBatchWidth points at a time with AVX2 or SSE4.1
+/// when the build targets them, scalar otherwise. Output is in [-1, 1] and depends only on params and position
+extern const int NoiseBatchWidth;
+
+/// fBm of 2D noise at (x, z0 + i * step) for i in [0, count)
+void FractalNoiseRow2D(float* out, int count, float x, float z0, float step, const NoiseParams& params);
+/// fBm of 3D noise at (x, y, z0 + i * step) for i in [0, count)
+void FractalNoiseRow3D(float* out, int count, float x, float y, float z0, float step, const NoiseParams& params);
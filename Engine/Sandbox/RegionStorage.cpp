@@ -0,0 +1,279 @@
+#include "RegionStorage.hpp"
+#include "Base.hpp"
+
+#include <filesystem>
+
+static uint32_t Crc32(const uint8_t* data, size_t size)
+{
+    static const std::array<uint32_t, 256> table = []()
+    {
+        std::array<uint32_t, 256> values;
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++)
+                crc = (crc & 1) ? (crc >> 1) ^ 0xedb88320u : crc >> 1;
+            values[i] = crc;
+        }
+        return values;
+    }();
+
+    uint32_t crc = 0xffffffffu;
+    for (size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return crc ^ 0xffffffffu;
+}
+
+static void StoreU32(uint8_t* out, uint32_t value)
+{
+    for (int byte = 0; byte < 4; byte++, value >>= 8)
+        out[byte] = static_cast<uint8_t>(value);
+}
+
+static uint32_t LoadU32(const uint8_t* in)
+{
+    return uint32_t(in[0]) | uint32_t(in[1]) << 8 | uint32_t(in[2]) << 16 | uint32_t(in[3]) << 24;
+}
+
+static int FloorDiv(int value, int divisor)
+{
+    return (value >= 0) ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+RegionFile::RegionFile(const std::string& path)
+    : m_Path(path)
+{
+    if (!Open() && !Create())
+        ET_ERROR("Can't open region file", path);
+}
+
+RegionFile::~RegionFile()
+{
+    if (m_File != nullptr)
+        std::fclose(m_File);
+}
+
+bool RegionFile::Open()
+{
+    m_File = std::fopen(m_Path.c_str(), "r+b");
+    if (m_File == nullptr)
+        return false;
+
+    std::vector<uint8_t> header(headerSize);
+    std::fseek(m_File, 0, SEEK_END);
+    m_FileSize = static_cast<uint64_t>(std::ftell(m_File));
+    std::fseek(m_File, 0, SEEK_SET);
+
+    if (std::fread(header.data(), 1, headerSize, m_File) != headerSize || LoadU32(&header[0]) != magic || LoadU32(&header[4]) != version)
+    {
+        ET_WARN("Region file", m_Path, "has unknown format, starting it over");
+        std::fclose(m_File);
+        m_File = nullptr;
+        return false;
+    }
+
+    m_LiveBytes = 0;
+    for (int i = 0; i < chunkCount; i++)
+    {
+        const uint8_t* stored = &header[2 * sizeof(uint32_t) + i * entrySize];
+        Entry& entry    = m_Entries[i];
+        entry.offset    = LoadU32(stored);
+        entry.size      = LoadU32(stored + 4);
+        entry.checksum  = LoadU32(stored + 8);
+
+        // Record past end of file was never completely written
+        if (entry.offset != 0 && uint64_t(entry.offset) + entry.size > m_FileSize)
+            entry = Entry();
+        m_LiveBytes += entry.size;
+    }
+
+    return m_Map.Open(m_Path);
+}
+
+bool RegionFile::Create()
+{
+    m_File = std::fopen(m_Path.c_str(), "w+b");
+    if (m_File == nullptr)
+        return false;
+
+    m_Entries.fill(Entry());
+    const std::vector<uint8_t> header = EncodeHeader(m_Entries);
+    std::fwrite(header.data(), 1, header.size(), m_File);
+    std::fflush(m_File);
+
+    m_FileSize  = headerSize;
+    m_LiveBytes = 0;
+    return m_Map.Open(m_Path);
+}
+
+void RegionFile::WriteEntry(int index)
+{
+    uint8_t stored[entrySize];
+    StoreU32(stored, m_Entries[index].offset);
+    StoreU32(stored + 4, m_Entries[index].size);
+    StoreU32(stored + 8, m_Entries[index].checksum);
+
+    std::fseek(m_File, static_cast<long>(2 * sizeof(uint32_t) + index * entrySize), SEEK_SET);
+    std::fwrite(stored, entrySize, 1, m_File);
+}
+
+std::vector<uint8_t> RegionFile::EncodeHeader(const std::array<Entry, chunkCount>& entries)
+{
+    std::vector<uint8_t> header(headerSize);
+    StoreU32(&header[0], magic);
+    StoreU32(&header[4], version);
+    for (int i = 0; i < chunkCount; i++)
+    {
+        uint8_t* stored = &header[2 * sizeof(uint32_t) + i * entrySize];
+        StoreU32(stored, entries[i].offset);
+        StoreU32(stored + 4, entries[i].size);
+        StoreU32(stored + 8, entries[i].checksum);
+    }
+    return header;
+}
+
+bool RegionFile::Read(int index, ChunkData& data)
+{
+    const Entry& entry = m_Entries[index];
+    if (entry.offset == 0)
+        return false;
+
+    // Record was appended after file was mapped
+    if (uint64_t(entry.offset) + entry.size > m_Map.GetSize() && !m_Map.Remap())
+        return false;
+
+    const uint8_t* record = m_Map.GetData() + entry.offset;
+    if (Crc32(record, entry.size) != entry.checksum)
+    {
+        ET_WARN("Chunk", index, "in", m_Path, "is corrupted, it will be regenerated");
+        return false;
+    }
+
+    return data.Decode(record, entry.size);
+}
+
+bool RegionFile::Write(int index, const std::vector<uint8_t>& record)
+{
+    if (m_File == nullptr)
+        return false;
+
+    std::fseek(m_File, 0, SEEK_END);
+    const uint64_t offset = static_cast<uint64_t>(std::ftell(m_File));
+    if (std::fwrite(record.data(), 1, record.size(), m_File) != record.size())
+        return false;
+
+    Entry& entry    = m_Entries[index];
+    m_LiveBytes     = m_LiveBytes - entry.size + record.size();
+    entry.offset    = static_cast<uint32_t>(offset);
+    entry.size      = static_cast<uint32_t>(record.size());
+    entry.checksum  = Crc32(record.data(), record.size());
+    m_FileSize      = offset + record.size();
+
+    // Table is updated after record is written, so a crash in between only loses this write
+    WriteEntry(index);
+    std::fflush(m_File);
+    return true;
+}
+
+bool RegionFile::IsFragmented() const
+{
+    const uint64_t records = m_FileSize - headerSize;
+    return records > 64 * 1024 && records > 2 * m_LiveBytes;
+}
+
+bool RegionFile::Compact()
+{
+    // Records appended by Write since the file was mapped lie past the end of the mapping
+    if (m_Map.GetSize() < m_FileSize && (!m_Map.Remap() || m_Map.GetSize() < m_FileSize))
+        return false;
+
+    const std::string tempPath = m_Path + ".tmp";
+    std::FILE* temp = std::fopen(tempPath.c_str(), "wb");
+    if (temp == nullptr)
+        return false;
+
+    std::array<Entry, chunkCount> entries = m_Entries;
+    uint32_t offset = headerSize;
+    for (Entry& entry : entries)
+    {
+        if (entry.offset == 0)
+            continue;
+        entry.offset = offset;
+        offset += entry.size;
+    }
+
+    const std::vector<uint8_t> header = EncodeHeader(entries);
+    bool written = std::fwrite(header.data(), 1, header.size(), temp) == header.size();
+    for (int i = 0; i < chunkCount && written; i++)
+    {
+        if (m_Entries[i].offset != 0)
+            written = std::fwrite(m_Map.GetData() + m_Entries[i].offset, 1, m_Entries[i].size, temp) == m_Entries[i].size;
+    }
+    written = (std::fclose(temp) == 0) && written;
+
+    if (!written)
+    {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    // Nothing may keep file open while it's replaced
+    m_Map.Close();
+    std::fclose(m_File);
+    m_File = nullptr;
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, m_Path, error);
+    if (error)
+        ET_ERROR("Can't replace region file", m_Path, error.message());
+
+    return Open() && !error;
+}
+
+RegionStorage::RegionStorage(const std::string& directory)
+    : m_Directory(directory)
+{
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+        ET_ERROR("Can't create save directory", directory, error.message());
+}
+
+glm::ivec3 RegionStorage::ToRegion(const glm::ivec3& coord)
+{
+    return { FloorDiv(coord.x, RegionFile::size), coord.y, FloorDiv(coord.z, RegionFile::size) };
+}
+
+int RegionStorage::ToIndex(const glm::ivec3& coord)
+{
+    const glm::ivec3 region = ToRegion(coord);
+    return (coord.x - region.x * RegionFile::size) * RegionFile::size + (coord.z - region.z * RegionFile::size);
+}
+
+RegionFile* RegionStorage::GetRegion(const glm::ivec3& region)
+{
+    auto& file = m_Regions[region];
+    if (file == nullptr)
+    {
+        const std::string name = "r." + std::to_string(region.x) + "." + std::to_string(region.y) + "." + std::to_string(region.z) + ".etr";
+        file = std::make_unique<RegionFile>((std::filesystem::path(m_Directory) / name).string());
+    }
+
+    return file->IsOpen() ? file.get() : nullptr;
+}
+
+bool RegionStorage::Load(const glm::ivec3& coord, ChunkData& data)
+{
+    RegionFile* region = GetRegion(ToRegion(coord));
+    return region != nullptr && region->Read(ToIndex(coord), data);
+}
+
+void RegionStorage::Save(const glm::ivec3& coord, const ChunkData& data)
+{
+    RegionFile* region = GetRegion(ToRegion(coord));
+    if (region == nullptr || !region->Write(ToIndex(coord), data.Encode()))
+        return;
+
+    if (region->IsFragmented() && !region->Compact())
+        ET_WARN("Region of chunk", coord.x, coord.y, coord.z, "wasn't compacted");
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "MappedFile.hpp"
+#include "ChunkData.hpp"
+#include "ChunkMap.hpp"
+
+/// File holding up to 32x32 chunks of one chunk layer.
+/// Layout: magic, version, offset table of chunkCount entries { offset, size, crc32 }, then chunk records.
+/// Records are only ever appended, rewriting a chunk leaves its old record dead until Compact.
+/// Reads go through a memory mapping of the file. Integers are stored little endian
+class RegionFile
+{
+    public:
+        static const int        size        = 32;
+        static const int        chunkCount  = size * size;
+    private:
+        struct Entry
+        {
+            uint32_t offset     = 0;    // 0 = chunk not stored
+            uint32_t size       = 0;
+            uint32_t checksum   = 0;
+        };
+
+        static const uint32_t   magic       = 0x47525445;   // "ETRG"
+        static const uint32_t   version     = 1;
+        static const uint32_t   entrySize   = 3 * sizeof(uint32_t);
+        static const uint32_t   headerSize  = 2 * sizeof(uint32_t) + chunkCount * entrySize;
+
+        std::string                     m_Path;
+        std::FILE*                      m_File = nullptr;
+        Eternity::MappedFile            m_Map;
+        std::array<Entry, chunkCount>   m_Entries;
+        uint64_t                        m_FileSize  = 0;
+        uint64_t                        m_LiveBytes = 0;    // bytes of records referenced by table
+
+        bool Open();
+        bool Create();
+        void WriteEntry(int index);
+        /// Magic, version and offset table as stored, headerSize bytes
+        static std::vector<uint8_t> EncodeHeader(const std::array<Entry, chunkCount>& entries);
+    public:
+        RegionFile(const std::string& path);
+        ~RegionFile();
+
+        bool IsOpen() const { return m_File != nullptr; }
+
+        /// Decode stored chunk, false if it isn't stored or record fails checksum
+        bool Read(int index, ChunkData& data);
+        bool Write(int index, const std::vector<uint8_t>& record);
+        /// Rewrite file with live records only
+        bool Compact();
+        /// Dead records outweigh live ones
+        bool IsFragmented() const;
+};
+
+/// Persists chunk blocks in region files under a directory, one file per 32x32 chunks of a chunk layer
+class RegionStorage
+{
+    private:
+        std::string                                                 m_Directory;
+        ChunkMap<std::unique_ptr<RegionFile>>                       m_Regions;
+
+        RegionFile* GetRegion(const glm::ivec3& region);
+        static glm::ivec3 ToRegion(const glm::ivec3& coord);
+        static int ToIndex(const glm::ivec3& coord);
+    public:
+        RegionStorage(const std::string& directory);
+
+        bool Load(const glm::ivec3& coord, ChunkData& data);
+        /// Append chunk to its region, region is compacted once it is mostly dead records
+        void Save(const glm::ivec3& coord, const ChunkData& data);
+};
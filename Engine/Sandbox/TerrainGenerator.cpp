@@ -0,0 +1,121 @@
+#include "TerrainGenerator.hpp"
+#include "Base.hpp"
+
+#include <array>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+TerrainGenerator::TerrainGenerator(const TerrainSettings& settings /* = {} */)
+    : m_Settings(settings)
+{
+    m_HeightNoise.seed          = settings.seed;
+    m_HeightNoise.frequency     = settings.heightFrequency;
+    m_HeightNoise.octaves       = settings.heightOctaves;
+
+    m_DensityNoise.seed         = settings.seed ^ 0x5bd1e995u;
+    m_DensityNoise.frequency    = settings.densityFrequency;
+    m_DensityNoise.octaves      = settings.densityOctaves;
+}
+
+void TerrainGenerator::Generate(const glm::ivec3& coord, ChunkData& data) const
+{
+    const glm::ivec3 origin = coord * chunkSize;
+
+    std::array<float, chunkSize * chunkSize> heights;
+    float minHeight = m_Settings.baseHeight + m_Settings.heightAmplitude;
+    float maxHeight = m_Settings.baseHeight - m_Settings.heightAmplitude;
+    for (int x = 0; x < chunkSize; x++)
+    {
+        float* row = &heights[x * chunkSize];
+        FractalNoiseRow2D(row, chunkSize, static_cast<float>(origin.x + x), static_cast<float>(origin.z), 1.0f, m_HeightNoise);
+        for (int z = 0; z < chunkSize; z++)
+        {
+            row[z]      = m_Settings.baseHeight + row[z] * m_Settings.heightAmplitude;
+            minHeight   = std::min(minHeight, row[z]);
+            maxHeight   = std::max(maxHeight, row[z]);
+        }
+    }
+
+    // Density noise is within [-1, 1], so past squash distance from surface the block is decided by height alone
+    if (origin.y > maxHeight + m_Settings.squash)
+    {
+        data.Fill(Block::Type::Air);
+        return;
+    }
+    if (origin.y + chunkSize < minHeight - m_Settings.squash)
+    {
+        data.Fill(Block::Type::Ground);
+        return;
+    }
+
+    std::vector<Block::Type> blocks(chunkVolume);
+    // One extra layer above the chunk tells whether top blocks are exposed
+    std::array<float, chunkSize> density;
+    std::array<bool, chunkSize> solidAbove;
+
+    for (int x = 0; x < chunkSize; x++)
+    {
+        const float* columnHeights = &heights[x * chunkSize];
+        for (int y = chunkSize; y >= 0; y--)
+        {
+            const float worldY = static_cast<float>(origin.y + y);
+            FractalNoiseRow3D(density.data(), chunkSize, static_cast<float>(origin.x + x), worldY, static_cast<float>(origin.z), 1.0f, m_DensityNoise);
+
+            for (int z = 0; z < chunkSize; z++)
+            {
+                const bool solid = (columnHeights[z] - worldY) / m_Settings.squash + density[z] > 0.0f;
+                if (y < chunkSize)
+                {
+                    Block::Type type = Block::Type::Air;
+                    if (solid)
+                        type = solidAbove[z] ? Block::Type::Ground : Block::Type::TopGround;
+                    blocks[VoxelIndex({ x, y, z })] = type;
+                }
+                solidAbove[z] = solid;
+            }
+        }
+    }
+
+    data.Assign(blocks);
+}
+
+void TerrainGenerator::ReportThroughput(uint32_t voxelsPerThread /* = 1u << 20 */) const
+{
+    // Same amount of work at every chunk size, so runs built with different sizes compare
+    const int chunksPerThread = static_cast<int>(std::max(1u, voxelsPerThread / chunkVolume));
+
+    // Chunks along a strip at surface level, so both early outs and full noise evaluation are measured
+    const int surfaceLayer = static_cast<int>(m_Settings.baseHeight) / chunkSize;
+    auto generateStrip = [&](int strip)
+    {
+        ChunkData data;
+        for (int i = 0; i < chunksPerThread; i++)
+            Generate({ i / 3, surfaceLayer - 1 + i % 3, strip }, data);
+    };
+
+    using Clock = std::chrono::high_resolution_clock;
+    auto secondsSince = [](Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::chrono::seconds::period>(Clock::now() - start).count();
+    };
+
+    const double chunkVoxels = chunkVolume;
+
+    auto start = Clock::now();
+    generateStrip(0);
+    const double singleSeconds = secondsSince(start);
+
+    const uint32_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    start = Clock::now();
+    for (uint32_t t = 0; t < threadCount; t++)
+        threads.emplace_back(generateStrip, static_cast<int>(t) + 1);
+    for (auto& thread : threads)
+        thread.join();
+    const double multiSeconds = secondsSince(start);
+
+    ET_INFO("Terrain generator: noise batch width", NoiseBatchWidth, ", chunk size", chunkSize);
+    ET_INFO("Terrain generator 1 thread:", chunksPerThread * chunkVoxels / singleSeconds, "voxels/s");
+    ET_INFO("Terrain generator", threadCount, "threads:", threadCount * chunksPerThread * chunkVoxels / multiSeconds, "voxels/s");
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "ChunkData.hpp"
+#include "Noise.hpp"
+
+struct TerrainSettings
+{
+    uint32_t    seed                = 1337;
+    float       baseHeight          = 10.0f;        // mean surface height in blocks
+    float       heightAmplitude     = 8.0f;         // surface varies by this much around base height
+    float       heightFrequency     = 1.0f / 48.0f;
+    int         heightOctaves       = 4;
+    float       densityFrequency    = 1.0f / 16.0f;
+    int         densityOctaves      = 2;
+    float       squash              = 4.0f;         // blocks away from surface at which density noise stops mattering
+};
+
+/// Builds chunk blocks from heightmap and 3D density noise. A block is solid where
+/// (height - y) / squash + density > 0, which gives rolling hills with overhangs near surface.
+/// Output depends only on settings and chunk coordinate, so chunks can be generated on any thread in any order
+class TerrainGenerator
+{
+    private:
+        TerrainSettings m_Settings;
+        NoiseParams     m_HeightNoise;
+        NoiseParams     m_DensityNoise;
+    public:
+        TerrainGenerator(const TerrainSettings& settings = {});
+
+        void Generate(const glm::ivec3& coord, ChunkData& data) const;
+
+        /// Log voxels per second generated on one thread and on all hardware threads
+        void ReportThroughput(uint32_t voxelsPerThread = 1u << 20) const;
+
+        const TerrainSettings& GetSettings() const { return m_Settings; }
+};
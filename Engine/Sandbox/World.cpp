@@ -0,0 +1,731 @@
+#include "World.hpp"
+#include "Base.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <unordered_set>
+
+static int FloorMod(int value, int divisor)
+{
+    const int mod = value % divisor;
+    return mod < 0 ? mod + divisor : mod;
+}
+
+World::World(const glm::ivec3& extent /* = { 16, 4, 16 } */, const TerrainSettings& terrain /* = {} */, MeshMode mode /* = MeshMode::Greedy */)
+    : m_Extent(extent), m_MeshMode(mode), m_Generator(terrain)
+{
+    ET_ASSERT(extent.x > 0 && extent.y > 0 && extent.z > 0);
+    const size_t slotCount = static_cast<size_t>(extent.x) * extent.y * extent.z;
+    m_Slots.resize(slotCount);
+    m_DirtyMasks.resize(slotCount, 0);
+    m_LightMarks.resize(slotCount, 0);
+    m_VisibleMarks.resize(slotCount, 0);
+}
+
+World::~World()
+{
+    SaveChunks();
+}
+
+void World::EnableStorage(const std::string& directory)
+{
+    m_Storage = std::make_unique<RegionStorage>(directory);
+}
+
+void World::SaveChunks()
+{
+    if (m_Storage == nullptr)
+        return;
+
+    ForEachChunk([&](Chunk& chunk)
+    {
+        if (!chunk.IsUnsaved())
+            return;
+        m_Storage->Save(chunk.GetCoord(), chunk.GetData());
+        chunk.SetUnsaved(false);
+    });
+}
+
+size_t World::SlotIndex(const glm::ivec3& coord) const
+{
+    return (static_cast<size_t>(FloorMod(coord.x, m_Extent.x)) * m_Extent.y + FloorMod(coord.y, m_Extent.y)) * m_Extent.z
+        + FloorMod(coord.z, m_Extent.z);
+}
+
+glm::ivec3 World::ToChunkCoord(const glm::ivec3& pos)
+{
+    return { BlockToChunk(pos.x), BlockToChunk(pos.y), BlockToChunk(pos.z) };
+}
+
+glm::ivec3 World::ToLocalPos(const glm::ivec3& pos)
+{
+    return { BlockToLocal(pos.x), BlockToLocal(pos.y), BlockToLocal(pos.z) };
+}
+
+Chunk* World::CreateChunk(const glm::ivec3& coord)
+{
+    auto& chunk = m_Slots[SlotIndex(coord)];
+    if (chunk != nullptr)
+    {
+        ET_ASSERT(chunk->GetCoord() == coord);
+        return chunk.get();
+    }
+
+    chunk = std::make_unique<Chunk>(coord, m_MeshMode);
+    if (m_Storage == nullptr || !m_Storage->Load(coord, chunk->GetData()))
+        chunk->GenerateLandscape(m_Generator);
+    m_ChunkCount++;
+    m_VisibilityDirty = true;
+
+    // Neighbors are remeshed together with chunk once it's lit
+    m_LightChunks.push_back(coord);
+    MarkDirty(coord);
+
+    return chunk.get();
+}
+
+std::unique_ptr<Chunk> World::RemoveChunk(const glm::ivec3& coord)
+{
+    auto& slot = m_Slots[SlotIndex(coord)];
+    if (slot == nullptr || slot->GetCoord() != coord)
+        return nullptr;
+
+    std::unique_ptr<Chunk> chunk = std::move(slot);
+    m_ChunkCount--;
+    m_VisibilityDirty = true;
+
+    if (m_Storage != nullptr && chunk->IsUnsaved())
+    {
+        m_Storage->Save(coord, chunk->GetData());
+        chunk->SetUnsaved(false);
+    }
+
+    for (int f = 0; f < 6; f++)
+        MarkDirty(coord + GetFaceNormal(static_cast<BlockFace>(f)));
+
+    return chunk;
+}
+
+Chunk* World::GetChunk(const glm::ivec3& coord) const
+{
+    Chunk* chunk = m_Slots[SlotIndex(coord)].get();
+    return (chunk != nullptr && chunk->GetCoord() == coord) ? chunk : nullptr;
+}
+
+void World::SetLod(const glm::ivec3& coord, int lod)
+{
+    ET_ASSERT(lod >= 0 && lod < lodCount);
+    Chunk* chunk = GetChunk(coord);
+    if (chunk == nullptr || chunk->GetLod() == lod)
+        return;
+
+    chunk->SetLod(lod);
+    // Neighbors cull border faces against this chunk only while both share LOD
+    MarkDirty(coord);
+    for (int f = 0; f < 6; f++)
+        MarkDirty(coord + GetFaceNormal(static_cast<BlockFace>(f)));
+}
+
+Block World::GetBlock(const glm::ivec3& pos) const
+{
+    const Chunk* chunk = GetChunk(ToChunkCoord(pos));
+    return chunk != nullptr ? chunk->GetData().At(ToLocalPos(pos)) : Block();
+}
+
+void World::SetBlock(const glm::ivec3& pos, Block::Type type)
+{
+    Chunk* chunk = GetChunk(ToChunkCoord(pos));
+    if (chunk == nullptr)
+        return;
+
+    if (chunk->GetData().At(ToLocalPos(pos)).type == type)
+        return;
+
+    chunk->GetData().Set(ToLocalPos(pos), type);
+    chunk->SetUnsaved(true);
+    m_LightBlocks.push_back(pos);
+
+    // Faces of edited block and of blocks around it, which may be in other sections or chunks.
+    // Diagonal neighbors are included since block shades their face corners
+    for (int x = -1; x <= 1; x++)
+        for (int y = -1; y <= 1; y++)
+            for (int z = -1; z <= 1; z++)
+                MarkBlockDirty(pos + glm::ivec3(x, y, z));
+}
+
+RaycastHit World::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const
+{
+    RaycastHit hit;
+    const float length = glm::length(direction);
+    if (length == 0.0f)
+        return hit;
+
+    const float infinity = std::numeric_limits<float>::infinity();
+    const glm::vec3 dir = direction / length;
+    // Block b spans [b - 0.5, b + 0.5], shift so cell boundaries land on integers
+    const glm::vec3 start = origin + glm::vec3(0.5f);
+
+    glm::ivec3 step;
+    glm::vec3 tDelta;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        step[axis]      = dir[axis] > 0.0f ? 1 : (dir[axis] < 0.0f ? -1 : 0);
+        tDelta[axis]    = step[axis] != 0 ? 1.0f / std::abs(dir[axis]) : infinity;
+    }
+
+    // Crossing times are always measured from ray start, so error doesn't build up over long rays
+    auto crossing = [&](int axis, int cell, int cellSize)
+    {
+        if (step[axis] == 0)
+            return infinity;
+        const int boundary = (cell + (step[axis] > 0 ? 1 : 0)) * cellSize;
+        return (boundary - start[axis]) / dir[axis];
+    };
+
+    glm::ivec3 block = glm::ivec3(glm::floor(start));
+    glm::ivec3 normal(0);
+    float t = 0.0f;
+
+    while (t <= maxDistance)
+    {
+        const glm::ivec3 chunkCoord = ToChunkCoord(block);
+        const glm::ivec3 chunkMin   = chunkCoord * chunkSize;
+        const Chunk* chunk = GetChunk(chunkCoord);
+
+        if (chunk == nullptr || chunk->GetData().IsEmpty())
+        {
+            // Nothing to hit here, step to where ray leaves chunk
+            int exitAxis = 0;
+            float exitT = infinity;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                const float axisT = crossing(axis, chunkCoord[axis], chunkSize);
+                if (axisT < exitT)
+                {
+                    exitT = axisT;
+                    exitAxis = axis;
+                }
+            }
+            if (exitT > maxDistance)
+                break;
+
+            // Float position only picks block within exit face, chunk boundary itself is exact
+            block = glm::ivec3(glm::floor(start + dir * exitT));
+            block = glm::clamp(block, chunkMin, chunkMin + glm::ivec3(chunkSize - 1));
+            block[exitAxis] += step[exitAxis];
+            normal = glm::ivec3(0);
+            normal[exitAxis] = -step[exitAxis];
+            t = exitT;
+            continue;
+        }
+
+        glm::vec3 tMax;
+        for (int axis = 0; axis < 3; axis++)
+            tMax[axis] = crossing(axis, block[axis], 1);
+
+        const ChunkData& data = chunk->GetData();
+        glm::ivec3 local = block - chunkMin;
+        while (true)
+        {
+            const Block::Type type = data.At(local).type;
+            if (type != Block::Type::Air)
+            {
+                hit.hit         = true;
+                hit.block       = block;
+                hit.normal      = normal;
+                hit.distance    = t;
+                hit.type        = type;
+                return hit;
+            }
+
+            const int axis = tMax.x < tMax.y ? (tMax.x < tMax.z ? 0 : 2) : (tMax.y < tMax.z ? 1 : 2);
+            t = tMax[axis];
+            tMax[axis] += tDelta[axis];
+            block[axis] += step[axis];
+            local[axis] += step[axis];
+            normal = glm::ivec3(0);
+            normal[axis] = -step[axis];
+
+            if (t > maxDistance || local[axis] < 0 || local[axis] >= chunkSize)
+                break;
+        }
+    }
+
+    return hit;
+}
+
+std::vector<uint8_t> World::TestLineOfSight(const std::vector<SightLine>& lines) const
+{
+    std::vector<uint8_t> visible(lines.size());
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+        const glm::vec3 ray = lines[i].to - lines[i].from;
+        visible[i] = Raycast(lines[i].from, ray, glm::length(ray)).hit ? 0 : 1;
+    }
+    return visible;
+}
+
+std::vector<Chunk*> World::Update()
+{
+    std::vector<Chunk*> updated;
+
+    if (std::unique_ptr<LightPass> pass = m_LightWorker.Collect())
+        ApplyLightPass(*pass);
+    if (!m_LightWorker.IsBusy())
+        if (std::unique_ptr<LightPass> pass = BuildLightPass())
+            m_LightWorker.Submit(std::move(pass));
+
+    for (const DirtyChunk& dirty : TakeDirty())
+    {
+        // Patching sections of a chunk whose full mesh is still being built would lose that mesh
+        if ((dirty.mask & fullRemesh) != 0 || !dirty.chunk->CanPatchSections())
+        {
+            if (SubmitMesh(*dirty.chunk))
+                updated.push_back(dirty.chunk);
+            continue;
+        }
+
+        dirty.chunk->BumpRevision();
+        dirty.chunk->GenerateSections(dirty.mask, GatherBorders(dirty.chunk->GetCoord(), 0));
+        updated.push_back(dirty.chunk);
+    }
+
+    for (MeshWorkers::Result& result : m_MeshWorkers.Collect())
+    {
+        // Chunk was unloaded, reloaded or edited again since job was submitted
+        Chunk* chunk = GetChunk(result.coord);
+        if (chunk == nullptr || result.latestRevision != chunk->GetRevisionCounter() || chunk->GetRevision() != result.revision)
+            continue;
+
+        chunk->SetSections(std::move(result.sections), result.connectivity);
+        updated.push_back(chunk);
+    }
+
+    // New meshes come with new face connectivity
+    if (!updated.empty())
+        m_VisibilityDirty = true;
+
+    return updated;
+}
+
+std::vector<Chunk*> World::RemeshDirty()
+{
+    if (std::unique_ptr<LightPass> pass = m_LightWorker.Wait())
+        ApplyLightPass(*pass);
+    if (std::unique_ptr<LightPass> pass = BuildLightPass())
+    {
+        pass->Run();
+        ApplyLightPass(*pass);
+    }
+
+    std::vector<Chunk*> remeshed;
+    for (const DirtyChunk& dirty : TakeDirty())
+    {
+        // Invalidate any mesh still being built for old data
+        dirty.chunk->BumpRevision();
+        dirty.chunk->GenerateMesh(GatherBorders(dirty.chunk->GetCoord(), dirty.chunk->GetLod()));
+        remeshed.push_back(dirty.chunk);
+    }
+
+    if (!remeshed.empty())
+        m_VisibilityDirty = true;
+
+    return remeshed;
+}
+
+void World::UpdateVisibility(const glm::vec3& cameraPos)
+{
+    const glm::ivec3 center = ToChunkCoord(glm::ivec3(glm::floor(cameraPos + glm::vec3(0.5f))));
+    if (!m_VisibilityDirty && center == m_VisibilityCenter)
+        return;
+    m_VisibilityDirty   = false;
+    m_VisibilityCenter  = center;
+
+    // Camera outside loaded chunks, e.g. above world, looks at them from outside where no chunk hides another
+    Chunk* start = GetChunk(center);
+    if (start == nullptr)
+    {
+        ForEachChunk([](Chunk& chunk) { chunk.occluded = false; });
+        return;
+    }
+
+    struct Step
+    {
+        Chunk*      chunk;
+        int         entry;          // face of chunk the chain came in through, -1 for camera chunk
+        uint8_t     directions;     // bit per BlockFace the chain moved toward so far
+    };
+
+    std::fill(m_VisibleMarks.begin(), m_VisibleMarks.end(), 0);
+    std::vector<Step> queue;
+    queue.reserve(m_ChunkCount);
+    queue.push_back({ start, -1, 0 });
+    m_VisibleMarks[SlotIndex(center)] = 1;
+
+    // Breadth first, every chunk is entered once through first face reaching it
+    for (size_t i = 0; i < queue.size(); i++)
+    {
+        const Step step = queue[i];
+        const uint8_t exits = step.entry < 0 ? 63 : step.chunk->GetConnectivity().GetConnected(static_cast<BlockFace>(step.entry));
+
+        for (int f = 0; f < 6; f++)
+        {
+            // Going back against a direction already taken could only reach chunks seen around solid ground
+            if ((exits & (1u << f)) == 0 || (step.directions & (1u << (f ^ 1))) != 0)
+                continue;
+
+            const glm::ivec3 coord = step.chunk->GetCoord() + GetFaceNormal(static_cast<BlockFace>(f));
+            Chunk* next = GetChunk(coord);
+            if (next == nullptr || m_VisibleMarks[SlotIndex(coord)] != 0)
+                continue;
+
+            m_VisibleMarks[SlotIndex(coord)] = 1;
+            queue.push_back({ next, f ^ 1, static_cast<uint8_t>(step.directions | (1u << f)) });
+        }
+    }
+
+    ForEachChunk([&](Chunk& chunk) { chunk.occluded = m_VisibleMarks[SlotIndex(chunk.GetCoord())] == 0; });
+}
+
+void World::ReportMeshStats()
+{
+    MeshStats naive, greedy;
+    size_t dataBytes = 0;
+    size_t lodChunks[lodCount] = {};
+    size_t classChunks[4] = {};
+    std::unordered_set<uint64_t> meshKeys;
+    size_t sharedBytes = 0;
+    using Clock = std::chrono::high_resolution_clock;
+    double greedySeconds = 0.0;
+
+    ForEachChunk([&](const Chunk& chunk)
+    {
+        const int lod = chunk.GetLod();
+        const ChunkBorders borders = GatherBorders(chunk.GetCoord(), lod);
+
+        const MeshStats chunkNaive  = Mesher::Build(chunk.GetData(), borders, MeshMode::Naive, lod).GetStats();
+        const auto start = Clock::now();
+        const MeshStats chunkGreedy = Mesher::Build(chunk.GetData(), borders, MeshMode::Greedy, lod).GetStats();
+        greedySeconds += std::chrono::duration<double, std::chrono::seconds::period>(Clock::now() - start).count();
+
+        naive.vertices  += chunkNaive.vertices;
+        naive.indices   += chunkNaive.indices;
+        greedy.vertices += chunkGreedy.vertices;
+        greedy.indices  += chunkGreedy.indices;
+        dataBytes       += chunk.GetData().GetMemoryUsage();
+        lodChunks[lod]++;
+        classChunks[static_cast<int>(Mesher::Classify(chunk.GetData(), borders))]++;
+
+        // Renderer keeps one copy of each distinct mesh
+        if (chunk.meshKey != 0 && meshKeys.insert(chunk.meshKey).second)
+            sharedBytes += chunk.vertices.size() * sizeof(Vertex) + chunk.indices.size() * sizeof(uint32_t);
+    });
+
+    auto bytes = [](const MeshStats& stats) { return stats.vertices * sizeof(Vertex) + stats.indices * sizeof(uint32_t); };
+
+    ET_INFO("World:", m_ChunkCount, "chunks", dataBytes, "bytes of block data");
+    for (int lod = 0; lod < lodCount; lod++)
+        ET_INFO("World LOD", lod, "downsampled", GetLodScale(lod), "times:", lodChunks[lod], "chunks");
+    ET_INFO("World mesh naive:", naive.vertices, "vertices", naive.indices, "indices", bytes(naive), "bytes");
+    ET_INFO("World mesh greedy:", greedy.vertices, "vertices", greedy.indices, "indices", bytes(greedy), "bytes");
+    ET_INFO("World chunks empty:", classChunks[0], "buried:", classChunks[1], "full exposed:", classChunks[2], "mixed:", classChunks[3]);
+    ET_INFO("World current meshes:", meshKeys.size(), "distinct,", sharedBytes, "bytes uploaded with sharing");
+    if (m_ChunkCount > 0)
+        ET_INFO("World greedy meshing:", greedySeconds * 1e6 / m_ChunkCount, "us per chunk,", m_ChunkCount * chunkVolume / greedySeconds, "voxels/s");
+}
+
+void World::ReportLightThroughput() const
+{
+    std::vector<LightPass::RegionChunk> chunks;
+    std::vector<glm::ivec3> coords;
+    for (const auto& chunk : m_Slots)
+    {
+        if (chunk == nullptr)
+            continue;
+        chunks.push_back({ chunk->GetCoord(), chunk->GetData(), false });
+        coords.push_back(chunk->GetCoord());
+    }
+    if (chunks.empty())
+        return;
+
+    using Clock = std::chrono::high_resolution_clock;
+    const auto start = Clock::now();
+    LightPass pass(std::move(chunks), {}, std::move(coords));
+    pass.Run();
+    const double seconds = std::chrono::duration<double, std::chrono::seconds::period>(Clock::now() - start).count();
+
+    ET_INFO("World full light pass:", seconds * 1e6 / m_ChunkCount, "us per chunk,", m_ChunkCount * chunkVolume / seconds, "voxels/s");
+}
+
+void World::ReportRaycastThroughput(uint32_t rayCount /* = 100000 */) const
+{
+    std::vector<glm::ivec3> coords;
+    for (const auto& chunk : m_Slots)
+        if (chunk != nullptr)
+            coords.push_back(chunk->GetCoord());
+    if (coords.empty())
+        return;
+
+    std::mt19937 random(1337);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<SightLine> rays(rayCount);
+    for (SightLine& ray : rays)
+    {
+        // From above a loaded chunk, looking down at some angle like a player does
+        const glm::ivec3& coord = coords[random() % coords.size()];
+        ray.from    = glm::vec3(coord * chunkSize) + glm::vec3(unit(random), 1.0f + unit(random), unit(random)) * static_cast<float>(chunkSize);
+        ray.to      = glm::vec3(unit(random), -1.0f + 0.5f * unit(random), unit(random));
+    }
+
+    using Clock = std::chrono::high_resolution_clock;
+    const auto start = Clock::now();
+    uint32_t hits = 0;
+    for (const SightLine& ray : rays)
+        hits += Raycast(ray.from, ray.to, 64.0f).hit ? 1 : 0;
+    const double seconds = std::chrono::duration<double, std::chrono::seconds::period>(Clock::now() - start).count();
+
+    ET_INFO("World raycast:", seconds * 1e6 / rayCount, "us per ray,", hits, "of", rayCount, "rays hit");
+}
+
+void World::ReportVisibility()
+{
+    const glm::ivec3 column(m_Extent.x / 2, 0, m_Extent.z / 2);
+    for (int y = 0; y < m_Extent.y; y++)
+    {
+        const glm::ivec3 coord(column.x, y, column.z);
+        if (GetChunk(coord) == nullptr)
+            continue;
+
+        using Clock = std::chrono::high_resolution_clock;
+        const auto start = Clock::now();
+        m_VisibilityDirty = true;
+        UpdateVisibility(glm::vec3(coord * chunkSize) + glm::vec3(chunkSize / 2));
+        const double seconds = std::chrono::duration<double, std::chrono::seconds::period>(Clock::now() - start).count();
+
+        size_t visible = 0;
+        ForEachChunk([&](const Chunk& chunk) { visible += chunk.occluded ? 0 : 1; });
+        ET_INFO("World visibility from chunk layer", y, ":", visible, "of", m_ChunkCount, "chunks visible in", seconds * 1e6, "us");
+    }
+}
+
+ChunkBorders World::GatherBorders(const glm::ivec3& coord, int lod) const
+{
+    ChunkBorders borders;
+    for (int f = 0; f < 6; f++)
+    {
+        const BlockFace face = static_cast<BlockFace>(f);
+        const Chunk* neighbor = GetChunk(coord + GetFaceNormal(face));
+        if (neighbor == nullptr || neighbor->GetLod() != lod)
+            continue;
+
+        if (lod == 0)
+        {
+            borders.layers[f] = neighbor->GetData().GetBorderLayer(GetOppositeFace(face));
+            // Unlit neighbor gets remeshed with its light soon, until then faces toward it are fully lit
+            if (neighbor->IsLit())
+                borders.light[f] = neighbor->GetData().GetBorderLight(GetOppositeFace(face));
+        }
+        else
+            borders.layers[f] = neighbor->GetData().Downsample(GetLodScale(lod)).GetBorderLayer(GetOppositeFace(face));
+    }
+    return borders;
+}
+
+void World::MarkDirty(const glm::ivec3& coord, uint32_t mask /* = fullRemesh */)
+{
+    if (GetChunk(coord) == nullptr)
+        return;
+
+    const size_t slot = SlotIndex(coord);
+    if (m_DirtyMasks[slot] == 0)
+        m_Dirty.push_back(slot);
+    m_DirtyMasks[slot] |= mask;
+}
+
+void World::MarkBlockDirty(const glm::ivec3& pos)
+{
+    MarkDirty(ToChunkCoord(pos), 1u << Mesher::GetSection(ToLocalPos(pos).y));
+}
+
+std::vector<World::DirtyChunk> World::TakeDirty()
+{
+    std::vector<DirtyChunk> dirty;
+    dirty.reserve(m_Dirty.size());
+
+    size_t kept = 0;
+    for (size_t slot : m_Dirty)
+    {
+        // Chunk may have been removed after it was marked
+        if (m_Slots[slot] == nullptr)
+        {
+            m_DirtyMasks[slot] = 0;
+            continue;
+        }
+
+        if (!m_Slots[slot]->IsLit())
+        {
+            m_Dirty[kept++] = slot;
+            continue;
+        }
+
+        dirty.push_back({ m_Slots[slot].get(), m_DirtyMasks[slot] });
+        m_DirtyMasks[slot] = 0;
+    }
+    m_Dirty.resize(kept);
+
+    return dirty;
+}
+
+bool World::SubmitMesh(Chunk& chunk)
+{
+    // Air needs no borders to know it has no faces
+    ChunkBorders borders;
+    if (!chunk.GetData().IsEmpty())
+        borders = GatherBorders(chunk.GetCoord(), chunk.GetLod());
+
+    if (!Mesher::HasFaces(chunk.GetData(), borders))
+    {
+        // Invalidate any mesh still being built for old data
+        chunk.BumpRevision();
+        chunk.SetSections(std::vector<ChunkMesh>(meshSectionCount), FaceConnectivity::Compute(chunk.GetData()));
+        return true;
+    }
+
+    MeshWorkers::Job job;
+    job.coord           = chunk.GetCoord();
+    job.revision        = chunk.BumpRevision();
+    job.latestRevision  = chunk.GetRevisionCounter();
+    job.data            = chunk.GetData();
+    job.borders         = std::move(borders);
+    job.mode            = chunk.GetMeshMode();
+    job.lod             = chunk.GetLod();
+
+    chunk.SetMeshInFlight(true);
+    m_MeshWorkers.Submit(std::move(job));
+    return false;
+}
+
+std::unique_ptr<LightPass> World::BuildLightPass()
+{
+    if (m_LightBlocks.empty() && m_LightChunks.empty())
+        return nullptr;
+
+    enum : uint8_t { unmarked, editable, frozen };
+    std::vector<size_t> slots;
+
+    // Light can change up to maxLightLevel blocks around a change, and all the way down through open sky
+    const int below = std::max(lightRadiusChunks, m_Extent.y - 1);
+    auto markAround = [&](const glm::ivec3& center)
+    {
+        for (int x = -lightRadiusChunks; x <= lightRadiusChunks; x++)
+            for (int y = -below; y <= lightRadiusChunks; y++)
+                for (int z = -lightRadiusChunks; z <= lightRadiusChunks; z++)
+                {
+                    const glm::ivec3 coord = center + glm::ivec3(x, y, z);
+                    if (GetChunk(coord) == nullptr)
+                        continue;
+                    const size_t slot = SlotIndex(coord);
+                    if (m_LightMarks[slot] == unmarked)
+                        slots.push_back(slot);
+                    m_LightMarks[slot] = editable;
+                }
+    };
+
+    for (const glm::ivec3& pos : m_LightBlocks)
+        markAround(ToChunkCoord(pos));
+    for (const glm::ivec3& coord : m_LightChunks)
+        markAround(coord);
+
+    // Loaded chunks just outside feed light in without being changed
+    const size_t editableCount = slots.size();
+    for (size_t i = 0; i < editableCount; i++)
+    {
+        const glm::ivec3 coord = m_Slots[slots[i]]->GetCoord();
+        for (int f = 0; f < 6; f++)
+        {
+            const glm::ivec3 neighbor = coord + GetFaceNormal(static_cast<BlockFace>(f));
+            if (GetChunk(neighbor) == nullptr)
+                continue;
+            const size_t slot = SlotIndex(neighbor);
+            if (m_LightMarks[slot] == unmarked)
+            {
+                m_LightMarks[slot] = frozen;
+                slots.push_back(slot);
+            }
+        }
+    }
+
+    std::vector<LightPass::RegionChunk> chunks;
+    chunks.reserve(slots.size());
+    for (size_t slot : slots)
+    {
+        const Chunk& chunk = *m_Slots[slot];
+        chunks.push_back({ chunk.GetCoord(), chunk.GetData(), m_LightMarks[slot] == frozen });
+        m_LightMarks[slot] = unmarked;
+    }
+
+    return std::make_unique<LightPass>(std::move(chunks), std::move(m_LightBlocks), std::move(m_LightChunks));
+}
+
+void World::ApplyLightPass(LightPass& pass)
+{
+    const std::vector<glm::ivec3>& newChunks = pass.GetNewChunks();
+    for (LightPass::Result& result : pass.TakeResults())
+    {
+        // Chunk was freed, or freed and loaded again after pass was built
+        Chunk* chunk = GetChunk(result.coord);
+        if (chunk == nullptr || (!chunk->IsLit() && std::find(newChunks.begin(), newChunks.end(), result.coord) == newChunks.end()))
+            continue;
+
+        chunk->GetData().SetLight(std::move(result.light));
+        MarkLightDirty(result);
+    }
+
+    for (const glm::ivec3& coord : newChunks)
+    {
+        Chunk* chunk = GetChunk(coord);
+        if (chunk == nullptr || chunk->IsLit())
+            continue;
+
+        // Chunk hides border faces of already loaded neighbors
+        chunk->SetLit(true);
+        MarkDirty(coord);
+        for (int f = 0; f < 6; f++)
+            MarkDirty(coord + GetFaceNormal(static_cast<BlockFace>(f)));
+    }
+}
+
+void World::MarkLightDirty(const LightPass::Result& result)
+{
+    // Faces read light of the voxel in front of them, so a changed layer affects blocks one layer above and below it
+    uint32_t sections = 0;
+    for (int y = 0; y < chunkSize; y++)
+    {
+        if ((result.changedLayers & (1ull << y)) == 0)
+            continue;
+        for (int dy = -1; dy <= 1; dy++)
+            if (y + dy >= 0 && y + dy < chunkSize)
+                sections |= 1u << Mesher::GetSection(y + dy);
+    }
+
+    // Coarse meshes don't show light
+    auto mark = [&](const glm::ivec3& coord, uint32_t mask)
+    {
+        const Chunk* chunk = GetChunk(coord);
+        if (chunk != nullptr && chunk->GetLod() == 0)
+            MarkDirty(coord, mask);
+    };
+
+    mark(result.coord, sections);
+    if ((result.changedLayers & 1) != 0)
+        mark(result.coord + glm::ivec3(0, -1, 0), 1u << Mesher::GetSection(chunkSize - 1));
+    if ((result.changedLayers & (1ull << (chunkSize - 1))) != 0)
+        mark(result.coord + glm::ivec3(0, 1, 0), 1u << Mesher::GetSection(0));
+
+    for (BlockFace face : { BlockFace::Left, BlockFace::Right, BlockFace::Back, BlockFace::Front })
+        if ((result.changedBorders & (1u << static_cast<int>(face))) != 0)
+            mark(result.coord + GetFaceNormal(face), sections);
+}
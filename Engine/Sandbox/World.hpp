@@ -0,0 +1,148 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Chunk.hpp"
+#include "LightWorker.hpp"
+#include "MeshWorkers.hpp"
+#include "RegionStorage.hpp"
+#include "TerrainGenerator.hpp"
+
+struct RaycastHit
+{
+    bool        hit         = false;
+    glm::ivec3  block       = { 0, 0, 0 };  // world position of hit block
+    glm::ivec3  normal      = { 0, 0, 0 };  // outward normal of face ray entered through, zero if ray starts inside block
+    float       distance    = 0.0f;         // along normalized ray direction
+    Block::Type type        = Block::Type::Air;
+};
+
+struct SightLine
+{
+    glm::vec3   from;
+    glm::vec3   to;
+};
+
+/// Owns chunks by integer chunk coordinate and keeps their meshes consistent across chunk borders.
+/// Chunks live in a toroidal ring of slots addressed by coordinate modulo ring extent,
+/// so any window of chunks no larger than the extent maps to distinct slots without hashing
+class World
+{
+    private:
+        // Dirty mask bits below meshSectionCount are mesh sections touched by block edits
+        static const uint32_t fullRemesh = 1u << 31;
+        static_assert(meshSectionCount < 31, "Section dirty bits must stay below fullRemesh");
+
+        struct DirtyChunk
+        {
+            Chunk*      chunk;
+            uint32_t    mask;
+        };
+
+        glm::ivec3                              m_Extent;
+        std::vector<std::unique_ptr<Chunk>>     m_Slots;
+        std::vector<size_t>                     m_Dirty;        // slots waiting for remesh
+        std::vector<uint32_t>                   m_DirtyMasks;
+        size_t                                  m_ChunkCount = 0;
+        std::vector<glm::ivec3>                 m_LightBlocks;  // blocks changed since last light pass was built
+        std::vector<glm::ivec3>                 m_LightChunks;  // chunks waiting for first light pass
+        std::vector<uint8_t>                    m_LightMarks;   // per slot, chunk role while building light pass
+        std::vector<uint8_t>                    m_VisibleMarks; // per slot, reached by last visibility traversal
+        glm::ivec3                              m_VisibilityCenter  = { 0, 0, 0 };
+        bool                                    m_VisibilityDirty   = true;     // chunks or their connectivity changed
+        MeshMode                                m_MeshMode;
+        TerrainGenerator                        m_Generator;
+        std::unique_ptr<RegionStorage>          m_Storage;
+        MeshWorkers                             m_MeshWorkers;
+        LightWorker                             m_LightWorker;
+
+        size_t SlotIndex(const glm::ivec3& coord) const;
+        /// Border layers of neighbors meshed at same LOD, downsampled to it. Layers toward neighbors at other LOD
+        /// are left empty so border faces facing them are always emitted and close seams between both meshes
+        ChunkBorders GatherBorders(const glm::ivec3& coord, int lod) const;
+        void MarkDirty(const glm::ivec3& coord, uint32_t mask = fullRemesh);
+        /// Mark mesh section holding block at world position
+        void MarkBlockDirty(const glm::ivec3& pos);
+        /// Take dirty chunks that can be meshed, unlit ones stay dirty until their light arrives
+        std::vector<DirtyChunk> TakeDirty();
+        /// Queue full mesh build on workers. Chunks without faces get their empty mesh right away and true is returned
+        bool SubmitMesh(Chunk& chunk);
+
+        /// Light pass over every pending change and chunks within light reach of it, nullptr if nothing changed
+        std::unique_ptr<LightPass> BuildLightPass();
+        void ApplyLightPass(LightPass& pass);
+        /// Remesh sections whose faces see voxels of changed light
+        void MarkLightDirty(const LightPass::Result& result);
+    public:
+        /// World able to hold extent.x * extent.y * extent.z chunks at once
+        World(const glm::ivec3& extent = { 16, 4, 16 }, const TerrainSettings& terrain = {}, MeshMode mode = MeshMode::Greedy);
+        /// Saves unsaved chunks if storage is enabled
+        ~World();
+
+        /// Load chunks from region files in directory before generating them, and save them there when freed
+        void EnableStorage(const std::string& directory);
+        void SaveChunks();
+
+        static glm::ivec3 ToChunkCoord(const glm::ivec3& pos);
+        static glm::ivec3 ToLocalPos(const glm::ivec3& pos);
+
+        /// Slot of coord must be free, returns already loaded chunk if it's the same coord
+        Chunk*  CreateChunk(const glm::ivec3& coord);
+        /// Detach chunk from world, saving it first. Caller must unload its model from renderer before releasing it
+        std::unique_ptr<Chunk> RemoveChunk(const glm::ivec3& coord);
+        Chunk*  GetChunk(const glm::ivec3& coord) const;
+        /// Mesh chunk at given level of detail, it and its neighbors are remeshed on next Update if it changed
+        void    SetLod(const glm::ivec3& coord, int lod);
+        /// Chunk currently occupying slot coord maps to, may have any coordinate congruent to it
+        Chunk*  GetSlot(const glm::ivec3& coord) const { return m_Slots[SlotIndex(coord)].get(); }
+
+        /// Block at world position, Air if chunk isn't loaded
+        Block   GetBlock(const glm::ivec3& pos) const;
+        /// Change block at world position. Mesh sections of it and its neighbors, which may lie in other chunks,
+        /// get rebuilt on next Update. Light around it follows once light pass is done
+        void    SetBlock(const glm::ivec3& pos, Block::Type type);
+
+        /// First solid block along ray within maxDistance, found by grid traversal (Amanatides & Woo).
+        /// Missing and all-Air chunks are crossed in one step. Only reads world, safe to call from several threads
+        RaycastHit Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const;
+        /// For every line, 1 if no solid block is entered between its ends, 0 otherwise
+        std::vector<uint8_t> TestLineOfSight(const std::vector<SightLine>& lines) const;
+
+        /// Queue changed chunks for meshing on worker threads and pick up finished meshes without waiting.
+        /// Sections touched by block edits are rebuilt right away on calling thread.
+        /// Light changes since last pass are batched into the next pass on light worker.
+        /// Returns chunks whose mesh must be reuploaded
+        std::vector<Chunk*> Update();
+        /// Update light and rebuild meshes of all changed chunks on calling thread
+        std::vector<Chunk*> RemeshDirty();
+
+        /// Mark chunks occluded unless camera chunk sees them through a chain of chunks whose entry and exit faces
+        /// are connected by Air. Chains never step back along an axis they already moved along.
+        /// Only redone when camera changes chunk or chunks change, does nothing to chunks if camera chunk isn't loaded
+        void UpdateVisibility(const glm::vec3& cameraPos);
+
+        /// Log total vertex and index counts of naive and greedy meshes of all loaded chunks at their LOD
+        void ReportMeshStats();
+        /// Log time of lighting every loaded chunk from scratch in one light pass
+        void ReportLightThroughput() const;
+        /// Log time per ray of random rays cast from above loaded chunks toward them
+        void ReportRaycastThroughput(uint32_t rayCount = 100000) const;
+        /// Log chunks left visible by UpdateVisibility, and its time, with camera in middle column at each chunk layer
+        void ReportVisibility();
+
+        /// Call f(Chunk&) for every loaded chunk
+        template<typename F>
+        void ForEachChunk(F&& f)
+        {
+            for (auto& chunk : m_Slots)
+                if (chunk != nullptr)
+                    f(*chunk);
+        }
+
+        const glm::ivec3& GetExtent() const { return m_Extent; }
+        const TerrainGenerator& GetGenerator() const { return m_Generator; }
+        size_t GetChunkCount() const { return m_ChunkCount; }
+        size_t GetPendingMeshCount() const { return m_MeshWorkers.GetPendingCount(); }
+};
@@ -4,6 +4,8 @@
 // #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include <algorithm>
+
 #include "VulkanApp.hpp"
 
 #include "Utils.hpp"
@@ -14,6 +16,8 @@
 #include "Surface.hpp"
 #include "PhysicalDevice.hpp"
 #include "Device.hpp"
+#include "MemoryAllocator.hpp"
+#include "DeletionQueue.hpp"
 #include "Swapchain.hpp"
 #include "RenderPass.hpp"
 #include "Image.hpp"
@@ -22,6 +26,8 @@
 #include "Framebuffers.hpp"
 #include "CommandPool.hpp"
 #include "Buffer.hpp"
+#include "StagingRing.hpp"
+#include "GeometryBuffer.hpp"
 #include "UniformBuffer.hpp"
 #include "CommandBuffer.hpp"
 #include "Shader.hpp"
@@ -34,6 +40,11 @@
 #include "Renderable.hpp"
 #include "Camera.hpp"
 
+// Set by CMake to where glslc writes SPIR-V in build tree
+#ifndef ET_SHADER_DIR
+#error "ET_SHADER_DIR must point at compiled shaders"
+#endif
+
 const int MAX_FRAMES_IN_FLIGHT = 2;
 const std::string TEXTURE_PATH = "../textures/atlas.png";
 
@@ -65,14 +76,112 @@ namespace Eternity
 
     void VulkanApp::LoadModel(Renderable& model) 
     {
-        m_Device->WaitIdle();
-        
-        m_VertexBuffers.emplace_back(CreateVertexBuffer(*m_CommandPool, model.vertices.data(), sizeof(model.vertices[0]) * model.vertices.size()));
-        m_IndexBuffers.emplace_back(CreateIndexBuffer(*m_CommandPool, model.indices.data(), sizeof(model.indices[0]) * model.indices.size()));
+        const uint32_t vertexCount  = static_cast<uint32_t>(model.vertices.size());
+        const uint32_t indexCount   = static_cast<uint32_t>(model.indices.size());
 
-        CreateCommandBuffers();
+        if (!AdoptSharedMesh(model))
+        {
+            // Range other models draw too keeps its content, model gets its own
+            const bool shared = model.m_Mesh != nullptr && model.m_Mesh->users > 1;
+            const bool fits = model.m_Mesh != nullptr && !shared
+                && vertexCount <= model.m_Mesh->vertexCapacity && indexCount <= model.m_Mesh->indexCapacity;
+
+            if (!fits)
+            {
+                ReleaseMesh(model);
 
-        model.bind = m_VertexBuffers.size() - 1;
+                // Fully occluded chunks have no faces at all, nothing to upload or draw.
+                // Otherwise leave room to grow so following edits are written in place
+                if (indexCount != 0)
+                {
+                    model.m_Mesh = m_Geometry->Allocate(vertexCount + vertexCount / 2, indexCount + indexCount / 2);
+                    model.m_Mesh->users++;
+                }
+
+                InvalidateCommandBuffers();
+            }
+            else
+            {
+                // Geometry is rewritten in place, it no longer matches key it was offered under
+                const auto entry = m_SharedMeshes.find(model.m_UploadedMeshKey);
+                if (entry != m_SharedMeshes.end() && entry->second.mesh.lock() == model.m_Mesh)
+                    m_SharedMeshes.erase(entry);
+            }
+            model.m_UploadedMeshKey = 0;
+
+            if (model.m_Mesh != nullptr)
+            {
+                const uint32_t firstVertex  = static_cast<uint32_t>(std::min<size_t>(model.dirtyVertexOffset, vertexCount));
+                const uint32_t firstIndex   = static_cast<uint32_t>(std::min<size_t>(model.dirtyIndexOffset, indexCount));
+                m_Geometry->Upload(*model.m_Mesh, model.vertices.data(), firstVertex, vertexCount, model.indices.data(), firstIndex, indexCount);
+
+                if (model.meshKey != 0)
+                {
+                    m_SharedMeshes[model.meshKey] = { model.m_Mesh, model.vertices.size(), model.indices.size() };
+                    model.m_UploadedMeshKey = model.meshKey;
+                }
+            }
+        }
+
+        // Edits may grow or shrink geometry, bounds follow every upload
+        const size_t index = std::find(m_Models.begin(), m_Models.end(), &model) - m_Models.begin();
+        if (index == m_Models.size())
+        {
+            m_Models.push_back(&model);
+            m_ModelBounds.Push(model.boundsMin, model.boundsMax);
+        }
+        else
+            m_ModelBounds.Set(index, model.boundsMin, model.boundsMax);
+
+        model.dirtyVertexOffset = model.vertices.size();
+        model.dirtyIndexOffset  = model.indices.size();
+    }
+
+    bool VulkanApp::AdoptSharedMesh(Renderable& model)
+    {
+        const auto entry = m_SharedMeshes.find(model.meshKey);
+        if (model.meshKey == 0 || entry == m_SharedMeshes.end())
+            return false;
+
+        const SharedMesh& shared = entry->second;
+        std::shared_ptr<MeshRange> mesh = shared.mesh.lock();
+        if (mesh == nullptr)
+        {
+            m_SharedMeshes.erase(entry);
+            return false;
+        }
+        // Geometry isn't compared, 64-bit key is trusted to tell meshes apart. Differing counts
+        // catch some collisions for free, any other one draws geometry of another model
+        if (shared.vertexCount != model.vertices.size() || shared.indexCount != model.indices.size())
+            return false;
+
+        // Model may already draw this range, then its geometry is uploaded as it is
+        if (mesh != model.m_Mesh)
+        {
+            ReleaseMesh(model);
+            model.m_Mesh = std::move(mesh);
+            model.m_Mesh->users++;
+            InvalidateCommandBuffers();
+        }
+        model.m_UploadedMeshKey = model.meshKey;
+        return true;
+    }
+
+    void VulkanApp::ReleaseMesh(Renderable& model)
+    {
+        if (model.m_Mesh != nullptr)
+            model.m_Mesh->users--;
+
+        // Entry of range nobody draws anymore, though deletion queue keeps it alive a few frames
+        const auto entry = m_SharedMeshes.find(model.m_UploadedMeshKey);
+        if (entry != m_SharedMeshes.end() && (entry->second.mesh.expired() || (model.m_Mesh != nullptr && model.m_Mesh->users == 0 && entry->second.mesh.lock() == model.m_Mesh)))
+            m_SharedMeshes.erase(entry);
+        model.m_UploadedMeshKey = 0;
+
+        // Frames in flight may still draw range, it's reused once they're done
+        m_Deletions->Push(std::move(model.m_Mesh));
+        model.dirtyVertexOffset = 0;
+        model.dirtyIndexOffset  = 0;
     }
 
     void VulkanApp::Prepare()
@@ -89,6 +198,12 @@ namespace Eternity
 
         m_Framebuffers      = std::make_shared<Framebuffers>(*m_Swapchain, *m_RenderPass, *m_DepthImage);
         m_CommandPool       = std::make_shared<CommandPool>(*m_Device);
+        m_TransferPool      = std::make_shared<CommandPool>(*m_Device, QueueType::Transfer);
+        m_Deletions         = std::make_shared<DeletionQueue>();
+        // Streaming a few dozen chunk meshes per frame stays well within ring
+        m_Staging           = std::make_shared<StagingRing>(*m_TransferPool, 16 << 20);
+        // Room for a few hundred chunks before buffers grow
+        m_Geometry          = std::make_shared<GeometryBuffer>(*m_Staging, *m_Deletions, sizeof(Vertex), 1u << 20, 3u << 20, 4096);
 
         CreateDescriptorSetLayout();
 
@@ -108,6 +223,7 @@ namespace Eternity
     void VulkanApp::Cleanup()
     {
         m_Device->WaitIdle();
+        m_Deletions->Clear();
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
         {
             vkDestroySemaphore(*m_Device, renderFinishedSemaphores[i], nullptr);
@@ -152,10 +268,15 @@ namespace Eternity
 
     void VulkanApp::CreateGraphicsPipeline() 
     {
-        m_PipelineLayout = std::make_shared<GraphicsPipelineLayout>(*m_Device, *m_DescriptorSetLayout);
+        VkPushConstantRange drawConstants{};
+        drawConstants.stageFlags    = VK_SHADER_STAGE_VERTEX_BIT;
+        drawConstants.offset        = 0;
+        drawConstants.size          = sizeof(DrawConstants);
 
-        Shader vertShader(*m_Device, Shader::Type::Vertex, "../shaders/vert.spv");
-        Shader fragShader(*m_Device, Shader::Type::Vertex, "../shaders/frag.spv");
+        m_PipelineLayout = std::make_shared<GraphicsPipelineLayout>(*m_Device, *m_DescriptorSetLayout, std::vector{ drawConstants });
+
+        Shader vertShader(*m_Device, Shader::Type::Vertex, ET_SHADER_DIR "/vert.spv");
+        Shader fragShader(*m_Device, Shader::Type::Vertex, ET_SHADER_DIR "/frag.spv");
         
         ShaderStage shaderStage (vertShader, fragShader);
 
@@ -202,47 +323,75 @@ namespace Eternity
     void VulkanApp::CreateCommandBuffers() 
     {
         m_CommandBuffers.resize(m_Framebuffers->GetBuffersCount());
-        for (int i = 0; i < m_Framebuffers->GetBuffersCount(); i++)
-            m_CommandBuffers[i] = std::make_shared<CommandBuffer>(*m_Device, *m_CommandPool);
+        m_CommandBuffersStale.assign(m_CommandBuffers.size(), false);
+        m_RecordedVisible.resize(m_CommandBuffers.size());
 
         for (size_t i = 0; i < m_CommandBuffers.size(); i++) 
         {
-            m_CommandBuffers[i]->Begin();
+            // Buffers of images swapchain already had are kept and recorded again
+            if (m_CommandBuffers[i] == nullptr)
+                m_CommandBuffers[i] = std::make_shared<CommandBuffer>(*m_Device, *m_CommandPool);
+            RecordCommandBuffer(i);
+        }
+    }
 
-                VkRenderPassBeginInfo renderPassInfo{};
-                renderPassInfo.sType                = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-                renderPassInfo.renderPass           = *m_RenderPass;
-                renderPassInfo.framebuffer          = m_Framebuffers->GetBuffers().at(i);
-                renderPassInfo.renderArea.offset    = { 0, 0 };
-                renderPassInfo.renderArea.extent    = m_Swapchain->GetExtent();
+    void VulkanApp::InvalidateCommandBuffers()
+    {
+        m_CommandBuffersStale.assign(m_CommandBuffers.size(), true);
+    }
 
-                std::array<VkClearValue, 2> clearValues{};
-                clearValues[0].color = { 0.0f, 0.0f, 0.0f, 1.0f };
-                clearValues[1].depthStencil = { 1, 0 };
+    void VulkanApp::RecordCommandBuffer(size_t i)
+    {
+        // Fence of image was waited for, so its buffer is no longer pending
+        m_CommandBuffersStale[i] = false;
+        m_RecordedVisible[i] = m_ModelsVisible;
 
-                renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-                renderPassInfo.pClearValues = clearValues.data();
+        m_CommandBuffers[i]->Reset();
+        m_CommandBuffers[i]->Begin();
 
-                m_CommandBuffers[i]->BeginRenderPass(&renderPassInfo,  VK_SUBPASS_CONTENTS_INLINE);
-                    m_CommandBuffers[i]->BindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, *m_GraphicsPipeline);
+            VkRenderPassBeginInfo renderPassInfo{};
+            renderPassInfo.sType                = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            renderPassInfo.renderPass           = *m_RenderPass;
+            renderPassInfo.framebuffer          = m_Framebuffers->GetBuffers().at(i);
+            renderPassInfo.renderArea.offset    = { 0, 0 };
+            renderPassInfo.renderArea.extent    = m_Swapchain->GetExtent();
 
-                    for (size_t j = 0; j < m_VertexBuffers.size(); j++)
-                    {
-                        VkBuffer vertexBuffers[] = { *m_VertexBuffers[j] };
-                        VkDeviceSize offsets[] = { 0 };
+            std::array<VkClearValue, 2> clearValues{};
+            clearValues[0].color = { 0.0f, 0.0f, 0.0f, 1.0f };
+            clearValues[1].depthStencil = { 1, 0 };
 
-                        vkCmdBindVertexBuffers(*m_CommandBuffers[i], 0, 1, vertexBuffers, offsets);
+            renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+            renderPassInfo.pClearValues = clearValues.data();
 
-                        vkCmdBindIndexBuffer(*m_CommandBuffers[i], *m_IndexBuffers[j], 0, VK_INDEX_TYPE_UINT32);
+            m_CommandBuffers[i]->BeginRenderPass(&renderPassInfo,  VK_SUBPASS_CONTENTS_INLINE);
+                m_CommandBuffers[i]->BindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, *m_GraphicsPipeline);
 
-                        vkCmdBindDescriptorSets(*m_CommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, *m_PipelineLayout, 0, 1, &m_DescriptorSets->GetSet(i), 0, nullptr);
+                // Every model draws from same buffers, its ranges come with its draw command
+                VkBuffer vertexBuffers[] = { m_Geometry->GetVertexBuffer() };
+                VkDeviceSize offsets[] = { 0 };
 
-                        vkCmdDrawIndexed(*m_CommandBuffers[i], static_cast<uint32_t>(m_IndexBuffers[j]->GetSize() / sizeof(uint32_t)), 1, 0, 0, 0);
-                    }
+                vkCmdBindVertexBuffers(*m_CommandBuffers[i], 0, 1, vertexBuffers, offsets);
 
-                m_CommandBuffers[i]->EndRenderPass();
-            m_CommandBuffers[i]->End();
-        }
+                vkCmdBindIndexBuffer(*m_CommandBuffers[i], m_Geometry->GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
+
+                vkCmdBindDescriptorSets(*m_CommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, *m_PipelineLayout, 0, 1, &m_DescriptorSets->GetSet(i), 0, nullptr);
+
+                for (size_t m = 0; m < m_Models.size(); m++)
+                {
+                    // Models loaded after last culling are drawn until they're tested
+                    const Renderable* model = m_Models[m];
+                    if (model->m_Mesh == nullptr || (m < m_ModelsVisible.size() && !m_ModelsVisible[m]))
+                        continue;
+
+                    DrawConstants constants{};
+                    constants.origin = glm::vec4(model->origin, 1.0f);
+                    vkCmdPushConstants(*m_CommandBuffers[i], *m_PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(constants), &constants);
+
+                    vkCmdDrawIndexedIndirect(*m_CommandBuffers[i], m_Geometry->GetIndirectBuffer(), m_Geometry->GetDrawOffset(*model->m_Mesh), 1, sizeof(VkDrawIndexedIndirectCommand));
+                }
+
+            m_CommandBuffers[i]->EndRenderPass();
+        m_CommandBuffers[i]->End();
     }
 
     void VulkanApp::CreateSyncObjects() 
@@ -286,6 +435,8 @@ namespace Eternity
         ubo.proj = glm::perspective(glm::radians(45.0f), m_Swapchain->GetExtent().width / (float) m_Swapchain->GetExtent().height, 0.1f, 30.0f);
         ubo.proj[1][1] *= -1;
 
+        m_Frustum = Frustum(ubo.proj * ubo.view * ubo.model);
+
         void* data;
         m_UniformBuffers[currentImage]->MapMemory(sizeof(ubo), &data);
             std::memcpy(data, &ubo, sizeof(ubo));
@@ -294,34 +445,66 @@ namespace Eternity
 
     void VulkanApp::UnloadModel(Renderable& model)
     {
-        if (m_VertexBuffers.empty() || model.bind > m_VertexBuffers.size() - 1)
+        auto it = std::find(m_Models.begin(), m_Models.end(), &model);
+        if (it == m_Models.end())
             return;
-        m_Device->WaitIdle();
 
-        m_VertexBuffers.erase(m_VertexBuffers.begin() + model.bind);
-        m_IndexBuffers.erase(m_IndexBuffers.begin() + model.bind);
+        m_ModelBounds.Erase(it - m_Models.begin());
+        m_Models.erase(it);
+        ReleaseMesh(model);
 
-        CreateCommandBuffers();
+        InvalidateCommandBuffers();
+    }
+
+    void VulkanApp::CullModels()
+    {
+        m_ModelsVisible.resize(m_Models.size());
+        m_Frustum.Cull(m_ModelBounds, m_ModelsVisible.data());
+        for (size_t m = 0; m < m_Models.size(); m++)
+            if (m_Models[m]->occluded)
+                m_ModelsVisible[m] = 0;
+    }
+
+    void VulkanApp::ReportMemoryStats() const
+    {
+        m_Device->GetAllocator().ReportStats();
+        m_Geometry->ReportStats();
     }
 
     void VulkanApp::DrawFrame() 
     {
+        // Holes left by unloaded and regrown meshes close a little every frame
+        m_Geometry->Compact(1 << 20);
+        // Models loaded since last frame are copied ahead of this frame's draws, without waiting for them
+        m_Staging->Submit();
 
         VkResult result = m_Swapchain->AcquireNextImage(imageAvailableSemaphores[currentFrame], inFlightFences[currentFrame]);
 
+        // Fence just waited for is the one of frame that used this slot last
+        if (m_Deletions->GetFrame() >= MAX_FRAMES_IN_FLIGHT)
+            m_Deletions->Collect(m_Deletions->GetFrame() - MAX_FRAMES_IN_FLIGHT);
+
         UpdateUniformBuffer(m_Swapchain->GetActiveImageIndex());
+        CullModels();
 
         if (imagesInFlight[m_Swapchain->GetActiveImageIndex()] != VK_NULL_HANDLE) 
             vkWaitForFences(*m_Device, 1, &imagesInFlight[m_Swapchain->GetActiveImageIndex()], VK_TRUE, UINT64_MAX);
 
+        // Recorded draws depend on which models are visible, camera movement changes them as much as loading does
+        if (m_CommandBuffersStale[m_Swapchain->GetActiveImageIndex()] || m_RecordedVisible[m_Swapchain->GetActiveImageIndex()] != m_ModelsVisible)
+            RecordCommandBuffer(m_Swapchain->GetActiveImageIndex());
+
         imagesInFlight[m_Swapchain->GetActiveImageIndex()] = inFlightFences[currentFrame];
 
         VkSubmitInfo submitInfo{};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-        VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame]};
-        VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-        submitInfo.waitSemaphoreCount = 1;
+        // Copies submitted before this frame are waited for where draws read geometry, later copies overwriting
+        // what this frame draws wait for its draw semaphore value
+        VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame], m_Staging->GetCopySemaphore()};
+        VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT};
+        const uint64_t waitValues[] = {0, m_Staging->GetCopyValue()};
+        submitInfo.waitSemaphoreCount = 2;
         submitInfo.pWaitSemaphores = waitSemaphores;
         submitInfo.pWaitDstStageMask = waitStages;
 
@@ -329,14 +512,25 @@ namespace Eternity
         const VkCommandBuffer& cmdBuff = *m_CommandBuffers[m_Swapchain->GetActiveImageIndex()];
         submitInfo.pCommandBuffers = &cmdBuff;
 
-        VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
-        submitInfo.signalSemaphoreCount = 1;
+        VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame], m_Staging->GetDrawSemaphore()};
+        const uint64_t signalValues[] = {0, m_Staging->NextDrawValue()};
+        submitInfo.signalSemaphoreCount = 2;
         submitInfo.pSignalSemaphores = signalSemaphores;
 
+        // Values of binary semaphores are ignored
+        VkTimelineSemaphoreSubmitInfo timelineInfo{};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.waitSemaphoreValueCount = 2;
+        timelineInfo.pWaitSemaphoreValues = waitValues;
+        timelineInfo.signalSemaphoreValueCount = 2;
+        timelineInfo.pSignalSemaphoreValues = signalValues;
+        submitInfo.pNext = &timelineInfo;
+
         vkResetFences(*m_Device, 1, &inFlightFences[currentFrame]);
 
-        if (vkQueueSubmit(m_Device->GetQueue(QueueType::Present), 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) 
+        if (vkQueueSubmit(m_Device->GetQueue(QueueType::Graphics), 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) 
             throw std::runtime_error("failed to submit draw command buffer!");
+        m_Deletions->EndFrame();
 
         result = m_Swapchain->QueuePresent(m_Device->GetQueue(QueueType::Present), renderFinishedSemaphores[currentFrame]);
 
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include <cstring>
 #include <vulkan/vulkan.h>
 
+#include "Frustum.hpp"
+
 namespace Eternity
 {
     class Instance;
@@ -20,7 +23,10 @@ namespace Eternity
     class DescriptorSetLayout;
     class GraphicsPipelineLayout;
     class GraphicsPipeline;
-    class Buffer;
+    class DeletionQueue;
+    class StagingRing;
+    class GeometryBuffer;
+    struct MeshRange;
     class UniformBuffer;
     class DescriptorPool;
     class DescriptorSets;
@@ -42,19 +48,36 @@ namespace Eternity
             std::shared_ptr<RenderPass>                     m_RenderPass;
             std::shared_ptr<Framebuffers>                   m_Framebuffers;
             std::shared_ptr<CommandPool>                    m_CommandPool;
+            std::shared_ptr<CommandPool>                    m_TransferPool;         // uploads, same family as m_CommandPool without transfer queue
             std::shared_ptr<Image2D>                        m_TextureImage;
             std::shared_ptr<DescriptorSetLayout>            m_DescriptorSetLayout;
 
             std::shared_ptr<GraphicsPipelineLayout>         m_PipelineLayout;
             std::shared_ptr<GraphicsPipeline>               m_GraphicsPipeline;
+            std::shared_ptr<DeletionQueue>                  m_Deletions;            // released resources frames in flight may use
+            std::shared_ptr<StagingRing>                    m_Staging;              // uploads of a frame, submitted before its draws
+            std::shared_ptr<GeometryBuffer>                 m_Geometry;             // vertices and indices of all models
+
+            /// Uploaded geometry other models with same Renderable::meshKey can draw
+            struct SharedMesh
+            {
+                std::weak_ptr<MeshRange>    mesh;
+                size_t                      vertexCount;
+                size_t                      indexCount;
+            };
 
-            std::vector<std::shared_ptr<Buffer>>            m_VertexBuffers;
-            std::vector<std::shared_ptr<Buffer>>            m_IndexBuffers;
+            std::vector<Renderable*>                        m_Models;
+            std::unordered_map<uint64_t, SharedMesh>        m_SharedMeshes;         // by mesh key, entries expire with last user
+            BoundsList                                      m_ModelBounds;          // world space box of each model, same order
+            Frustum                                         m_Frustum;              // of camera in current frame
+            std::vector<uint8_t>                            m_ModelsVisible;        // models inside m_Frustum and not occluded
             std::vector<std::shared_ptr<UniformBuffer>>     m_UniformBuffers;
 
             std::shared_ptr<DescriptorPool>                 m_DescriptorPool;
             std::shared_ptr<DescriptorSets>                 m_DescriptorSets;
             std::vector<std::shared_ptr<CommandBuffer>>     m_CommandBuffers;
+            std::vector<bool>                               m_CommandBuffersStale;  // model set changed since recording
+            std::vector<std::vector<uint8_t>>               m_RecordedVisible;      // m_ModelsVisible each buffer was recorded with
 
             std::vector<VkSemaphore>    imageAvailableSemaphores;
             std::vector<VkSemaphore>    renderFinishedSemaphores;
@@ -78,15 +101,31 @@ namespace Eternity
             void CreateDescriptorPool();
             void CreateDescriptorSets();
             void CreateCommandBuffers();
+            /// Draws only models visible in current frame
+            void RecordCommandBuffer(size_t index);
+            /// Re-record each command buffer right before its image is drawn next, once it's no longer in flight
+            void InvalidateCommandBuffers();
             void CreateSyncObjects();
+            /// Also updates m_Frustum to camera of this frame
             void UpdateUniformBuffer(uint32_t currentImage);
+            void CullModels();
+            /// Point model at mesh range already holding its geometry, false if there is none
+            bool AdoptSharedMesh(Renderable& model);
+            /// Drop model mesh range, it's given back to m_Geometry once no model draws it and frames in flight are done
+            void ReleaseMesh(Renderable& model);
         public:
             VulkanApp();
             ~VulkanApp();
             
             void SetRenderCamera(std::shared_ptr<Camera>& camera);
+            /// Upload model geometry. Mesh range that still fits is rewritten in place from model dirty offsets on,
+            /// without waiting for device or re-recording command buffers. Model whose meshKey matches geometry
+            /// already uploaded draws that range instead of uploading its own
             void LoadModel(Renderable& model);
+            /// Stop drawing model, without waiting for frames in flight that still do
             void UnloadModel(Renderable& model);
             void DrawFrame();
+            /// Log device memory held and lost to rounding and fragmentation
+            void ReportMemoryStats() const;
     };
 }
\ No newline at end of file
@@ -0,0 +1,10 @@
+#include "./Sandbox/Benchmarks.hpp"
+
+#include <cstdlib>
+
+// Engine subsystems without renderer, built once per chunk size listed in ET_BENCH_CHUNK_SIZES
+int main()
+{
+    RunBenchmarks();
+    return EXIT_SUCCESS;
+}
@@ -1,13 +1,21 @@
 #include "Eternity.hpp"
-#include "./Sandbox/Chunk.hpp"
+#include "./Sandbox/Benchmarks.hpp"
+#include "./Sandbox/ChunkStreamer.hpp"
 // timing
 float deltaTime = 0.0f;	// time between current frame and last frame
 float lastFrame = 0.0f;
 
 using namespace Eternity;
 
-int main() 
+int main(int argc, char** argv) 
 {
+    // Measure engine subsystems without opening a window
+    if (argc > 1 && std::string(argv[1]) == "--bench")
+    {
+        RunBenchmarks();
+        return EXIT_SUCCESS;
+    }
+
     Eternity::CreateWindow(800, 600, "Eternity");
     Eternity::EventSystem::Init();
     Eternity::Input::Init();
@@ -15,12 +23,19 @@ int main()
     Eternity::VulkanApp app;
 	
 
-    std::shared_ptr<Camera> camera = std::make_shared<Camera>(glm::vec3(0.0f, 0.0f, 3.0f));
+    std::shared_ptr<Camera> camera = std::make_shared<Camera>(glm::vec3(0.0f, 24.0f, 3.0f));
     app.SetRenderCamera(camera);
 
-    Chunk chunk(glm::vec3(0, 0, 0));
+    TerrainSettings terrain;
+    StreamingSettings streaming;
+    // Distant chunks are meshed at lower LOD, so view distance can grow past full detail range
+    streaming.radius = 8;
+    // Enough chunk layers to hold surface at its highest
+    streaming.maxY = static_cast<int>(terrain.baseHeight + terrain.heightAmplitude + terrain.squash) / chunkSize;
 
-    app.LoadModel(chunk);
+    World world(streaming.GetWorldExtent(), terrain);
+    world.EnableStorage("saves/world");
+    ChunkStreamer streamer(world, streaming);
 
     while (!Eternity::WindowShouldClose()) 
     {
@@ -32,12 +47,33 @@ int main()
 
         camera->Update(deltaTime);
 
-        if (Eternity::Input::GetKeyDown(Key::X))
+        // Dig block under crosshair, or place ground (right button) or lamp (middle button) against face it's looked at through
+        const float reach = 8.0f;
+        if (Eternity::Input::GetButtonDown(Mouse::ButtonLeft))
+        {
+            const RaycastHit hit = world.Raycast(camera->Position, camera->Front, reach);
+            if (hit.hit)
+                world.SetBlock(hit.block, Block::Type::Air);
+        }
+        if (Eternity::Input::GetButtonDown(Mouse::ButtonRight) || Eternity::Input::GetButtonDown(Mouse::ButtonMiddle))
         {
-            chunk.TestBlockDig();
-            app.UnloadModel(chunk);
-            app.LoadModel(chunk);
+            const RaycastHit hit = world.Raycast(camera->Position, camera->Front, reach);
+            const Block::Type type = Eternity::Input::GetButtonDown(Mouse::ButtonMiddle) ? Block::Type::Lamp : Block::Type::Ground;
+            if (hit.hit && hit.normal != glm::ivec3(0))
+                world.SetBlock(hit.block + hit.normal, type);
         }
+        if (Eternity::Input::GetKeyDown(Key::P))
+        {
+            world.ReportMeshStats();
+            app.ReportMemoryStats();
+        }
+
+        for (std::unique_ptr<Chunk>& chunk : streamer.Update(camera->Position))
+            app.UnloadModel(*chunk);
+
+        for (Chunk* chunk : world.Update())
+            app.LoadModel(*chunk);
+        world.UpdateVisibility(camera->Position);
 
         EventSystem::PollEvents();
         app.DrawFrame();
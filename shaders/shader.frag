@@ -4,10 +4,16 @@
 layout(binding = 1) uniform sampler2D texSampler;
 
 layout(location = 0) in vec2 fragTexCoord;
+layout(location = 1) flat in vec2 fragTile;
+layout(location = 2) in float fragShade;
 
 layout(location = 0) out vec4 outColor;
 
+const float tileSize = 1.0 / 16.0;
+
 void main() 
 {
-    outColor = texture(texSampler, fragTexCoord);
+    // Merged quads carry texture coordinates in tile units, wrap them inside the atlas cell
+    vec4 color = texture(texSampler, fragTile + fract(fragTexCoord) * tileSize);
+    outColor = vec4(color.rgb * fragShade, color.a);
 }
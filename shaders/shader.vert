@@ -8,13 +8,43 @@ layout(binding = 0) uniform UBOMatrices
     mat4 proj;
 } ubo;
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec2 inTexCoord;
+layout(push_constant) uniform DrawConstants
+{
+    vec4 origin;
+} draw;
+
+// x, y, z (7 bits each), normal index (3 bits), corner id (2 bits)
+layout(location = 0) in uint inData;
+// atlas tile index (8 bits), ambient occlusion (2 bits), sky light (4 bits), block light (4 bits)
+layout(location = 1) in uint inMaterial;
 
 layout(location = 0) out vec2 fragTexCoord;
+layout(location = 1) flat out vec2 fragTile;
+layout(location = 2) out float fragShade;
+
+// Texture axes of each face in BlockFace order (Left, Right, Bottom, Top, Back, Front).
+// Texture repeats once per block, v runs down the side faces
+const vec3 uAxes[6] = vec3[](vec3(0, 0, 1), vec3(0, 0, -1), vec3(0, 0, 1), vec3(1, 0, 0), vec3(-1, 0, 0), vec3(1, 0, 0));
+const vec3 vAxes[6] = vec3[](vec3(0, -1, 0), vec3(0, -1, 0), vec3(1, 0, 0), vec3(0, 0, 1), vec3(0, -1, 0), vec3(0, -1, 0));
+
+const float tileSize = 1.0 / 16.0;
+// Brightness by number of occluding blocks around vertex, 3 = none
+const float occlusionCurve[4] = float[](0.45, 0.65, 0.82, 1.0);
+// Every light level is 20% darker than the one above, with some ambient light left in darkness
+const float ambientLight = 0.04;
 
 void main() 
 {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
-    fragTexCoord = inTexCoord;
+    vec3 localPos   = vec3(inData & 127u, (inData >> 7) & 127u, (inData >> 14) & 127u);
+    uint normal     = (inData >> 21) & 7u;
+    uint tile       = inMaterial & 255u;
+    uint occlusion  = (inMaterial >> 8) & 3u;
+    uint skyLight   = (inMaterial >> 10) & 15u;
+    uint blockLight = (inMaterial >> 14) & 15u;
+
+    gl_Position     = ubo.proj * ubo.view * ubo.model * vec4(draw.origin.xyz + localPos, 1.0);
+    fragTexCoord    = vec2(dot(localPos, uAxes[normal]), dot(localPos, vAxes[normal]));
+    fragTile        = vec2(tile % 16u, tile / 16u) * tileSize;
+    float light     = pow(0.8, 15.0 - float(max(skyLight, blockLight)));
+    fragShade       = occlusionCurve[occlusion] * max(light, ambientLight);
 }